@@ -1,8 +1,11 @@
 #ifndef BALL_HPP
 #define BALL_HPP
 
+#include <vector>
+#include <cstddef>
 #include "object.hpp"
-#include <sstream>
+#include "world_bounds.hpp"
+#include "world_params.hpp"
 
 class Ball : public Object {
 public:
@@ -11,11 +14,12 @@ public:
     Ball(float x, float y, float vx, float vy, float radius)
         : Object(ObjectType::BALL, x, y, vx, vy), radius(radius)
     {}
-
-    virtual void updatePhysics(float dt) override;
-    virtual void render(SDL_Renderer* renderer) const override;
-    virtual void renderVelocityInfo(SDL_Renderer* renderer, TTF_Font* font) const override;
-    SDL_Rect getBoundingBox() const;
 };
 
+// Advance the balls among objects[begin, end) by dt: integrate them, then
+// bounce them off the walls. Other objects are skipped. The kernel is picked
+// once from the params, not tested per ball.
+void stepBalls(std::vector<Object*>& objects, size_t begin, size_t end, float dt, const WorldBounds& bounds,
+               const WorldParams& params);
+
 #endif // BALL_HPP
\ No newline at end of file
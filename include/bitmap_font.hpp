@@ -0,0 +1,46 @@
+#ifndef BITMAP_FONT_HPP
+#define BITMAP_FONT_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Placement of one glyph in a BitmapFont atlas.
+struct Glyph {
+    uint16_t x, y;          // Top-left corner in the atlas
+    uint16_t width, height; // Size of the glyph image; 0 for blank glyphs
+    int16_t offsetX;        // From the pen position to the image's left edge
+    int16_t offsetY;        // From the top of the line to the image's top edge
+    int16_t advance;        // Pen movement after the glyph
+};
+
+// The printable ASCII glyphs of one font size, rasterised into a single
+// coverage (alpha) atlas.
+//
+// Fonts are baked at build time by tools/bake_font.cpp and embedded in the
+// binary as a blob, so the simulation itself never parses a TTF file.
+struct BitmapFont {
+    static constexpr int FIRST_CHAR = 32;
+    static constexpr int LAST_CHAR = 126;
+    static constexpr int GLYPH_COUNT = LAST_CHAR - FIRST_CHAR + 1;
+
+    int width = 0, height = 0;     // Atlas size in pixels
+    int lineHeight = 0;            // Distance between two lines
+    std::vector<uint8_t> coverage; // width * height alpha values
+    Glyph glyphs[GLYPH_COUNT] = {};
+
+    // Glyph for c, or null if the font does not cover it.
+    const Glyph* glyph(char c) const {
+        int code = static_cast<unsigned char>(c);
+        return code >= FIRST_CHAR && code <= LAST_CHAR ? &glyphs[code - FIRST_CHAR] : nullptr;
+    }
+
+    // Blob layout: "JPSF", version, atlas size, line height and glyph count
+    // (little-endian uint16), one record per glyph, then the coverage with
+    // runs of zeros stored as a 0 byte followed by the run length.
+    std::vector<uint8_t> serialize() const;
+    // Read a blob written by serialize(). Returns false if it is malformed.
+    bool load(const uint8_t* data, size_t size);
+};
+
+#endif // BITMAP_FONT_HPP
@@ -11,11 +11,6 @@ public:
     Box(float x, float y, float width, float height)
         : Object(ObjectType::BOX, x, y, 0.0f, 0.0f), width(width), height(height)
     {}
-
-    // Boxes are static; no physics update.
-    virtual void updatePhysics(float dt) override;
-    virtual void render(SDL_Renderer* renderer) const override;
-    SDL_Rect getBoundingBox() const;
 };
 
 #endif // BOX_HPP
\ No newline at end of file
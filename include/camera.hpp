@@ -0,0 +1,27 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include "world_bounds.hpp"
+
+// Maps world coordinates to window pixels: screen = (world - (x, y)) * zoom.
+struct Camera {
+    static constexpr float MIN_ZOOM = 0.01f;
+    static constexpr float MAX_ZOOM = 16.0f;
+
+    float x = 0.0f, y = 0.0f; // World position of the window's top-left corner
+    float zoom = 1.0f;        // Window pixels per world unit
+
+    float toScreenX(float worldX) const { return (worldX - x) * zoom; }
+    float toScreenY(float worldY) const { return (worldY - y) * zoom; }
+    float toWorldX(float screenX) const { return screenX / zoom + x; }
+    float toWorldY(float screenY) const { return screenY / zoom + y; }
+
+    // Move the view by a distance in window pixels.
+    void pan(float dx, float dy);
+    // Scale the zoom by factor, keeping the world point under (screenX, screenY) in place.
+    void zoomAt(float screenX, float screenY, float factor);
+    // Show the whole world centred in a view of the given size.
+    void fit(const WorldBounds& bounds, int viewWidth, int viewHeight);
+};
+
+#endif // CAMERA_HPP
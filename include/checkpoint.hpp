@@ -0,0 +1,69 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "world.hpp"
+#include "physics.hpp"
+
+// State of a run at a step boundary. Restoring it and stepping on gives
+// bit-identical results to never having stopped.
+//
+// The solvers rebuild their contacts from the objects every step, so apart
+// from the world nothing but the counters has to be kept.
+struct Checkpoint {
+    uint64_t step = 0;        // PhysicsStepper::stepCount()
+    uint64_t frame = 0;       // Frames recorded by a headless run
+    double accumulator = 0.0; // Simulated time not yet stepped
+    SolverMode mode = SolverMode::IMPULSE;
+    WorldState world;
+};
+
+// Write a checkpoint next to path and rename it into place, so a crash
+// while writing leaves the previous checkpoint intact.
+bool writeCheckpoint(const std::string& path, const Checkpoint& checkpoint);
+// Read a checkpoint. On failure error says why.
+bool readCheckpoint(const std::string& path, Checkpoint& checkpoint, std::string& error);
+
+// Writes checkpoints on a background thread.
+//
+// The simulation only copies its state into a Checkpoint under the world
+// mutex and submits it; serialising and disk I/O happen here. Checkpoints
+// are recycled, so taking one does not allocate after the first few.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // A checkpoint to fill, possibly holding an earlier state.
+    std::unique_ptr<Checkpoint> acquire();
+    // Queue a filled checkpoint. Never waits for I/O; if an older one is
+    // still queued it is replaced, since only the newest matters.
+    void submit(std::unique_ptr<Checkpoint> checkpoint);
+    // Wait until everything submitted is on disk. Returns false if any
+    // write failed.
+    bool flush();
+
+private:
+    void run();
+
+    std::string path;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool stopping = false;
+    bool writing = false;
+    bool failed = false;
+    std::unique_ptr<Checkpoint> pending;
+    std::vector<std::unique_ptr<Checkpoint>> spare;
+};
+
+#endif // CHECKPOINT_HPP
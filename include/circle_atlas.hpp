@@ -0,0 +1,67 @@
+#ifndef CIRCLE_ATLAS_HPP
+#define CIRCLE_ATLAS_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "circle_batch.hpp"
+#include "thread_pool.hpp"
+
+// Draws circles as textured quads from a texture atlas of pre-rasterised,
+// anti-aliased circle sprites.
+//
+// A sprite is rasterised once per distinct radius (rounded to half a pixel) and
+// style, in white, and tinted per circle through the vertex colour. All circles
+// of a frame are then submitted with one texture and one SDL_RenderGeometry call.
+class CircleAtlas {
+public:
+    // Largest radius worth a sprite; bigger circles are better drawn as meshes.
+    static constexpr float MAX_SPRITE_RADIUS = 64.0f;
+
+    void clear() { quads.clear(); }
+    void add(float x, float y, float radius, SDL_Color color, CircleStyle style);
+    size_t size() const { return quads.size(); }
+
+    // Upload new sprites and submit all quads. pool may be null.
+    void draw(SDL_Renderer* renderer, ThreadPool* pool);
+
+    // Free the atlas texture. Must be called before the renderer is destroyed;
+    // sprites are uploaded again on the next draw.
+    void releaseTexture();
+
+private:
+    struct Sprite {
+        int x, y;      // Top-left corner in the atlas
+        int size;      // Width and height in pixels
+        float radius;  // Radius of the circle inside the sprite
+    };
+
+    struct Quad {
+        float x, y, radius;
+        SDL_Color color;
+        uint32_t sprite;
+    };
+
+    uint32_t spriteFor(float radius, CircleStyle style);
+    void rasterise(const Sprite& sprite, CircleStyle style);
+    void grow(int minHeight);
+
+    std::unordered_map<uint32_t, uint32_t> spriteIndex; // Key -> index into sprites
+    std::vector<Sprite> sprites;
+    std::vector<Quad> quads;
+
+    // CPU copy of the atlas, RGBA32, ATLAS_WIDTH pixels per row.
+    std::vector<uint32_t> pixels;
+    int atlasHeight = 0;
+    int shelfX = 0, shelfY = 0, shelfHeight = 0;
+    bool dirty = false; // pixels changed since the last upload
+
+    SDL_Texture* texture = nullptr;
+    int textureHeight = 0;
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+#endif // CIRCLE_ATLAS_HPP
@@ -0,0 +1,46 @@
+#ifndef CIRCLE_BATCH_HPP
+#define CIRCLE_BATCH_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "thread_pool.hpp"
+
+// How circles are drawn.
+enum class CircleStyle {
+    OUTLINE, // One pixel wide ring
+    FILLED   // Solid disc
+};
+
+// Collects circles for a frame and draws all of them with a single
+// SDL_RenderGeometry call.
+//
+// Every circle becomes a triangle mesh whose segment count grows with its
+// radius, so small circles stay cheap and large ones stay round. Vertex
+// generation writes each circle into its own range of the buffers and can be
+// split across a ThreadPool.
+class CircleBatch {
+public:
+    void clear() { circles.clear(); }
+    void add(float x, float y, float radius, SDL_Color color);
+    size_t size() const { return circles.size(); }
+
+    // Build the meshes and submit them. pool may be null.
+    void draw(SDL_Renderer* renderer, CircleStyle style, ThreadPool* pool);
+
+private:
+    struct Circle {
+        float x, y, radius;
+        SDL_Color color;
+        int segments;
+    };
+
+    void build(CircleStyle style, ThreadPool* pool);
+
+    std::vector<Circle> circles;
+    std::vector<size_t> firstVertex; // Per circle, plus the total at the end
+    std::vector<size_t> firstIndex;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+#endif // CIRCLE_BATCH_HPP
@@ -1,12 +1,19 @@
 #ifndef COLLISION_HPP
 #define COLLISION_HPP
 
+#include <vector>
+#include <cstddef>
+#include "world_params.hpp"
+
 class Object;
+struct Contact;
 
-// Resolve a collision between two objects.
+// Resolve count contacts in order. Picks the friction or frictionless
+// variant once for the whole range.
 // - If both objects are dynamic (Ball), they share separation and exchange momentum.
 // - If one object is static (Box) and the other is dynamic, only the dynamic object is moved.
 // - If both are static, nothing happens.
-void resolveCollision(Object* a, Object* b);
+void resolveCollisions(std::vector<Object*>& objects, const Contact* contacts, size_t count,
+                       const WorldParams& params);
 
 #endif // COLLISION_HPP
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef COMMAND_BUFFER_HPP
+#define COMMAND_BUFFER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <cstdint>
+#include "circle_batch.hpp"
+
+// Drawing order of commands. A layer is drawn completely before the next one;
+// inside a layer commands are reordered to minimise renderer state changes.
+enum class DrawLayer : uint8_t {
+    WORLD,   // Objects and the ground
+    DEBUG,   // Bounding boxes and state labels
+    OVERLAY, // Spawn preview and selection
+    HUD      // Screen-space text
+};
+
+// Kinds of recorded drawing commands.
+enum class DrawOp : uint8_t {
+    POINT,
+    LINE,
+    AA_LINE,   // Anti-aliased line
+    RECT,      // Rectangle outline
+    FILL_RECT,
+    CIRCLE,
+    TEXT
+};
+
+// One recorded drawing command, in pixels.
+struct DrawCommand {
+    DrawOp op;
+    DrawLayer layer;
+    CircleStyle style;   // CIRCLE only
+    SDL_BlendMode blend; // Lines and rectangles
+    SDL_Color color;
+    // POINT: position. LINE: end points. RECT / FILL_RECT: x, y, width, height.
+    // CIRCLE: centre and radius in a. TEXT: top-left corner.
+    float x, y, a, b;
+    uint32_t text;       // TEXT only: offset into the string storage
+};
+
+// Everything to draw in one frame, as plain data.
+//
+// The render thread records a frame from a WorldSnapshot and a RenderQueue
+// draws it, so drawing never touches the live world or its mutex.
+class CommandBuffer {
+public:
+    void clear();
+
+    // Layer of the commands recorded from now on.
+    void setLayer(DrawLayer layer) { currentLayer = layer; }
+
+    void point(float x, float y, SDL_Color color);
+    void line(float x0, float y0, float x1, float y1, SDL_Color color);
+    void aaLine(float x0, float y0, float x1, float y1, SDL_Color color);
+    void rect(const SDL_Rect& rect, SDL_Color color);
+    void fillRect(const SDL_Rect& rect, SDL_Color color, SDL_BlendMode blend = SDL_BLENDMODE_NONE);
+    void circle(float x, float y, float radius, SDL_Color color, CircleStyle style);
+    void text(const char* str, float x, float y, SDL_Color color);
+    // Text with a shadow offset by (1, 1) underneath.
+    void shadowedText(const char* str, float x, float y, SDL_Color color, SDL_Color shadow);
+
+    const std::vector<DrawCommand>& commands() const { return list; }
+    const char* textOf(const DrawCommand& command) const { return &strings[command.text]; }
+
+private:
+    DrawCommand& push(DrawOp op, SDL_Color color);
+
+    DrawLayer currentLayer = DrawLayer::WORLD;
+    std::vector<DrawCommand> list;
+    std::vector<char> strings; // Null-terminated strings of TEXT commands
+};
+
+#endif // COMMAND_BUFFER_HPP
@@ -0,0 +1,70 @@
+#ifndef CONTACT_SOLVER_HPP
+#define CONTACT_SOLVER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "object.hpp"
+#include "thread_pool.hpp"
+#include "world_params.hpp"
+
+// A potentially colliding pair, stored as indices into the objects vector with a < b.
+struct Contact {
+    uint32_t a, b;
+};
+
+// Resolves all collisions of a step in parallel.
+//
+// resolveCollisions writes to both objects of a pair, so pairs are first coloured
+// such that no two contacts of one colour share a dynamic object. Each colour is
+// then resolved in parallel and colours run one after another. Detection,
+// colouring and the order within a colour only depend on the objects vector, so
+// the result is the same for any number of threads.
+class ContactSolver {
+public:
+    // Collect contacts, colour them and resolve them.
+    void solve(std::vector<Object*>& objects, const WorldParams& params, ThreadPool& pool);
+    // Resolve the contacts of the last prepare(), colour by colour.
+    void resolve(std::vector<Object*>& objects, const WorldParams& params, ThreadPool& pool);
+
+    // Collect and colour contacts without resolving them. The result is
+    // available through contacts() and batch().
+    void prepare(const std::vector<Object*>& objects, ThreadPool& pool);
+
+    // Contacts of the last prepare(), ordered by colour.
+    const std::vector<Contact>& contacts() const { return coloured; }
+    // Number of colours of the last prepare(), including the serial overflow batch.
+    size_t batchCount() const { return batchStart.empty() ? 0 : batchStart.size() - 1; }
+    // Range [begin, end) of the contacts belonging to colour k.
+    void batch(size_t k, size_t& begin, size_t& end) const { begin = batchStart[k]; end = batchStart[k + 1]; }
+    // True if batch k has to run serially because its contacts could not be coloured.
+    bool isSerialBatch(size_t k) const { return k + 1 == batchCount() && hasOverflow; }
+
+    // Extra distance added around dynamic objects during detection, so that
+    // contacts found once stay valid while the objects keep moving.
+    float margin = 0.0f;
+    // Dynamic objects are additionally widened by how far their current
+    // velocity carries them in this much time.
+    float sweepTime = 0.0f;
+
+private:
+    struct Bounds {
+        float minX, minY, maxX, maxY;
+        bool isStatic;
+    };
+
+    void findContacts(const std::vector<Object*>& objects, ThreadPool& pool);
+    void colourContacts(size_t objectCount);
+
+    std::vector<Bounds> bounds;
+    std::vector<uint32_t> sweepOrder;
+    std::vector<std::vector<Contact>> blockContacts;
+    std::vector<Contact> found;
+    std::vector<Contact> coloured;
+    std::vector<uint8_t> contactColour;
+    std::vector<uint64_t> usedColours;
+    std::vector<size_t> batchStart;
+    bool hasOverflow = false;
+};
+
+#endif // CONTACT_SOLVER_HPP
@@ -0,0 +1,47 @@
+#ifndef DENSITY_MAP_HPP
+#define DENSITY_MAP_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <cstdint>
+#include "camera.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+
+// Heatmap of how many balls cover each pixel, for views where balls are too
+// small to draw individually.
+//
+// Balls are binned into horizontal bands of rows in fixed chunks, then every
+// band counts its own pixels and maps the counts through a logarithmic
+// palette into a streaming texture. The caller bounds the cost by passing a
+// sample of the balls, each counted with the sampling weight.
+class DensityMap {
+public:
+    DensityMap();
+    ~DensityMap();
+
+    // Add the heatmap of the given balls to the renderer's target, each ball
+    // standing for `weight` balls. Pixels without balls are left untouched.
+    // pool may be null.
+    bool draw(SDL_Renderer* renderer, int width, int height, const std::vector<ObjectState>& objects,
+              const std::vector<size_t>& balls, uint32_t weight, const Camera& camera, ThreadPool* pool);
+    // Free the texture. Must be called before the renderer is destroyed.
+    void releaseTexture();
+
+private:
+    bool ensureTexture(SDL_Renderer* renderer, int width, int height);
+    void bin(size_t chunk, const std::vector<ObjectState>& objects,
+             const std::vector<size_t>& balls, const Camera& camera);
+    void fillBand(size_t band, uint32_t weight, uint8_t* pixels, int pitch);
+
+    SDL_Texture* texture = nullptr;
+    int textureWidth = 0, textureHeight = 0;
+    size_t bandCount = 0;
+
+    std::vector<uint32_t> palette; // ARGB8888 colour per count, saturating
+    std::vector<uint32_t> counts;  // Balls per pixel
+    // Per chunk of sampled balls, the pixel offsets falling into each band.
+    std::vector<std::vector<std::vector<uint32_t>>> chunkBins;
+};
+
+#endif // DENSITY_MAP_HPP
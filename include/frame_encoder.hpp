@@ -0,0 +1,59 @@
+#ifndef FRAME_ENCODER_HPP
+#define FRAME_ENCODER_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+
+// Container of an encoded video stream.
+enum class VideoFormat {
+    RGBA, // Raw frames, 4 bytes per pixel, no header
+    Y4M   // YUV4MPEG2, 4:2:0 full-range BT.601 (tagged XCOLORRANGE=FULL), readable by ffmpeg
+};
+
+// Converts and writes video frames on its own thread.
+//
+// The producer renders into a buffer from acquire() and hands it back with
+// submit(). A fixed number of buffers circulate, so a slow output only stalls
+// the producer once all of them are waiting to be written.
+class FrameEncoder {
+public:
+    FrameEncoder(FILE* out, VideoFormat format, int width, int height, int fps, size_t bufferCount = 4);
+    ~FrameEncoder();
+
+    FrameEncoder(const FrameEncoder&) = delete;
+    FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+    // An RGBA32 buffer of width * height * 4 bytes for the next frame.
+    std::vector<uint8_t>* acquire();
+    // Queue a buffer from acquire() to be written.
+    void submit(std::vector<uint8_t>* frame);
+
+    // Write every queued frame, then stop. Returns false if writing failed.
+    bool finish();
+
+private:
+    void run();
+    bool write(const std::vector<uint8_t>& frame);
+
+    FILE* out;
+    VideoFormat format;
+    int width, height, fps;
+
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<std::vector<uint8_t>*> freeBuffers;
+    std::deque<std::vector<uint8_t>*> queued;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool stopping = false;
+    bool failed = false;
+    bool headerWritten = false;
+    std::vector<uint8_t> planes; // Y, U and V planes of the frame being written
+    std::thread thread;
+};
+
+#endif // FRAME_ENCODER_HPP
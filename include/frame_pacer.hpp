@@ -0,0 +1,66 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <cstddef>
+
+// How the render thread decides when to start the next frame.
+enum class PacingMode {
+    VSYNC,    // Present blocks until the display's next refresh
+    UNCAPPED, // As fast as possible
+    TARGET    // A fixed rate, the display's refresh rate by default
+};
+
+// Frame times in milliseconds, measured from one present to the next.
+struct FrameStats {
+    float fps = 0.0f;
+    float p50 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+};
+
+// Paces frames and records how long each one took.
+//
+// Uses the high-resolution performance counter throughout. In TARGET mode
+// it sleeps through most of the wait and spins the last part, so frames are
+// not rounded to the scheduler's millisecond granularity.
+class FramePacer {
+public:
+    // Frames kept for the percentiles.
+    static constexpr size_t HISTORY = 1024;
+
+    // targetFps is only used in TARGET mode; 0 follows the display.
+    FramePacer(PacingMode mode = PacingMode::VSYNC, double targetFps = 0.0);
+
+    PacingMode mode() const { return pacingMode; }
+    // Flags to create the renderer with for this mode.
+    Uint32 rendererFlags() const;
+    // Refresh rate of the display the window is on, in Hz.
+    void setRefreshRate(int hz);
+
+    // Call right after presenting. Waits for the next frame's deadline in
+    // TARGET mode, then records the frame's time.
+    void endFrame();
+    // Statistics of the frames since the last call, or of the last HISTORY.
+    FrameStats takeStats();
+    // Length of the last frame in milliseconds.
+    float lastFrameMs() const { return lastFrameTime; }
+
+private:
+    PacingMode pacingMode;
+    double requestedFps;
+    Uint64 frequency;
+    Uint64 period = 0;       // TARGET mode frame length in counter ticks
+    Uint64 deadline = 0;
+    Uint64 lastFrame = 0;
+    Uint64 statsStart = 0;
+
+    std::vector<float> frameTimes; // Ring buffer of milliseconds
+    size_t nextSample = 0;
+    size_t framesSinceStats = 0;
+    float lastFrameTime = 0.0f;
+    std::vector<float> sorted;
+};
+
+#endif // FRAME_PACER_HPP
@@ -0,0 +1,43 @@
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+#include <string>
+#include "world.hpp"
+#include "physics.hpp"
+#include "scene_renderer.hpp"
+#include "frame_encoder.hpp"
+#include "checkpoint.hpp"
+
+// Settings of a run without a window.
+struct HeadlessSettings {
+    std::string output = "-";            // File to write, "-" for stdout
+    VideoFormat format = VideoFormat::Y4M;
+    int width = 800, height = 600;       // Video size in pixels
+    int fps = 60;                        // Video frames per simulated second
+    float duration = 10.0f;              // Simulated seconds to record
+    std::string checkpoint;              // Checkpoint file, empty for none
+    float checkpointInterval = 60.0f;    // Simulated seconds between checkpoints
+};
+
+// Simulate the world for settings.duration and record it as a video.
+//
+// Needs no display: frames are drawn by SDL's software renderer into a
+// surface in memory. Physics runs on the calling thread in fixed steps, with
+// exactly 1 / fps simulated seconds between two frames, so a run does not
+// depend on how fast the machine is. Frames are converted and written by a
+// FrameEncoder thread.
+//
+// With settings.checkpoint set, the state is saved every checkpointInterval
+// and at the end by a CheckpointWriter. A run continued from one of those
+// (world already restored, resume pointing at the checkpoint) records the
+// remaining frames identically to an uninterrupted run. Step and frame
+// times go to physics.metrics if set. Returns a process exit code.
+int runHeadless(World& world, const PhysicsSettings& physics, const ViewState& view, const HeadlessSettings& settings,
+                const Checkpoint* resume = nullptr);
+
+// Take steps physics steps of the world without drawing anything and print
+// the step rate and the final state hash to stdout. Returns a process exit
+// code.
+int runBenchmark(World& world, const PhysicsSettings& physics, long steps);
+
+#endif // HEADLESS_HPP
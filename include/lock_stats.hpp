@@ -0,0 +1,97 @@
+#ifndef LOCK_STATS_HPP
+#define LOCK_STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+// Places that take the world mutex.
+enum class LockSite : uint8_t {
+    STEP,     // Physics steps
+    SNAPSHOT, // Copies of the world for drawing or checkpoints
+    SPAWN,    // Adding balls, boxes and generated scenes
+    EDIT      // Removing objects and changing parameters from the UI
+};
+constexpr size_t LOCK_SITES = 4;
+
+const char* lockSiteName(LockSite site);
+
+// Wait and hold times of one mutex, by call site.
+//
+// Every lock taken through a TimedLock lands in a histogram of its wait
+// (until the mutex was acquired) and one of its hold time. Recording is a
+// few relaxed atomic adds, so it is always on. With startTrace, each lock
+// is also kept as an event for writeTrace.
+class LockStats {
+public:
+    // Buckets grow by 4x from 1 microsecond; the last one is unbounded.
+    static constexpr size_t BUCKETS = 10;
+
+    // Counts of one site, taken from the histograms.
+    struct Counts {
+        uint64_t wait[BUCKETS];
+        uint64_t hold[BUCKETS];
+        uint64_t waitNanos, holdNanos; // Sums
+        uint64_t locks;
+    };
+
+    LockStats();
+
+    // Upper bound of a bucket in nanoseconds, 0 for the last one.
+    static uint64_t bucketLimit(size_t bucket);
+
+    // Nanoseconds since this object was created.
+    uint64_t now() const;
+    void record(LockSite site, uint64_t start, uint64_t wait, uint64_t hold);
+    void read(LockSite site, Counts& counts) const;
+
+    // Keep up to capacity locks for writeTrace. Call before any thread
+    // takes a TimedLock.
+    void startTrace(size_t capacity);
+    // Write the kept locks as a Chrome trace (JSON), one lane per site.
+    // Call once no other thread takes a TimedLock any more.
+    bool writeTrace(const std::string& path) const;
+
+private:
+    struct Site {
+        std::atomic<uint64_t> wait[BUCKETS];
+        std::atomic<uint64_t> hold[BUCKETS];
+        std::atomic<uint64_t> waitNanos, holdNanos;
+    };
+    struct TraceEvent {
+        uint64_t start, wait, hold;
+        LockSite site;
+    };
+
+    static size_t bucket(uint64_t nanos);
+
+    std::chrono::steady_clock::time_point epoch;
+    Site sites[LOCK_SITES];
+    std::unique_ptr<TraceEvent[]> trace;
+    size_t traceCapacity = 0;
+    std::atomic<size_t> traceNext{0};
+};
+
+// Like std::lock_guard, but records the wait and hold time in a LockStats.
+class TimedLock {
+public:
+    TimedLock(std::mutex& mutex, LockStats& stats, LockSite site);
+    ~TimedLock();
+
+    TimedLock(const TimedLock&) = delete;
+    TimedLock& operator=(const TimedLock&) = delete;
+
+    // Seconds spent waiting for the mutex.
+    double waited() const { return (acquired - start) * 1e-9; }
+
+private:
+    std::mutex& mutex;
+    LockStats& stats;
+    LockSite site;
+    uint64_t start, acquired;
+};
+
+#endif // LOCK_STATS_HPP
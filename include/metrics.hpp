@@ -0,0 +1,62 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
+#include "snapshot.hpp"
+#include "lock_stats.hpp"
+
+// Histogram of durations with fixed buckets, in Prometheus' layout.
+//
+// observe() is a bucket search and two relaxed atomic adds, so any thread
+// may record without a lock. A reader sees every observation exactly once,
+// though counts and sum taken during an observe() may be one apart.
+class LatencyHistogram {
+public:
+    // Upper bounds of the buckets in seconds, ascending; +Inf is implied.
+    LatencyHistogram(std::initializer_list<double> bounds);
+
+    void observe(double seconds);
+    // Append the histogram in the Prometheus text format.
+    void write(std::string& out, const char* name, const char* help) const;
+
+private:
+    std::vector<double> bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts; // Per bucket, not cumulative
+    std::atomic<uint64_t> sumNanos{0};
+};
+
+// Simulation metrics for dashboards.
+//
+// The simulation threads only do relaxed atomic updates; counting objects,
+// formatting and reading process statistics happen in expose(), on the
+// exporter's thread.
+struct Metrics {
+    Metrics();
+
+    LatencyHistogram stepDuration;  // One physics step, world mutex held
+    LatencyHistogram frameDuration; // Present to present, or one headless frame
+    std::atomic<uint64_t> mutexWaitNanos{0}; // Physics thread waiting for world.mutex
+
+    // Object counts. With `snapshots` set they are taken from the latest
+    // snapshot when the metrics are exposed; otherwise from recordObjects.
+    const SnapshotBuffer* snapshots = nullptr;
+    std::atomic<uint32_t> balls{0};
+    std::atomic<uint32_t> boxes{0};
+    std::atomic<uint32_t> sleeping{0}; // Balls slower than REST_SPEED
+    std::atomic<uint32_t> contacts{0}; // Contacts of the last step
+    // World lock wait and hold times by site, if set.
+    const LockStats* locks = nullptr;
+
+    // Count the objects of a snapshot, for runs without a SnapshotBuffer.
+    // Runs over the copy, not the world.
+    void recordObjects(const WorldSnapshot& snapshot);
+    // All metrics in the Prometheus text exposition format (version 0.0.4).
+    std::string expose() const;
+};
+
+#endif // METRICS_HPP
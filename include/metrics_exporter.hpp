@@ -0,0 +1,47 @@
+#ifndef METRICS_EXPORTER_HPP
+#define METRICS_EXPORTER_HPP
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include "metrics.hpp"
+
+// Where metrics are published.
+struct MetricsSettings {
+    int port = 0;          // Serve http://127.0.0.1:port/metrics, 0 for no server
+    std::string file;      // Textfile to rewrite, empty for none
+    float interval = 5.0f; // Seconds between two textfile writes
+};
+
+// Publishes Metrics on a background thread.
+//
+// The server answers one scrape at a time on localhost only. The textfile
+// is written next to its path and renamed into place, so a collector never
+// reads a half-written file.
+class MetricsExporter {
+public:
+    MetricsExporter(const Metrics& metrics, const MetricsSettings& settings);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Open the port and start the thread. Returns false if the port cannot
+    // be opened.
+    bool start();
+    // Write the textfile a last time and stop.
+    void stop();
+
+private:
+    void run();
+    void serve();
+    bool writeFile() const;
+
+    const Metrics& metrics;
+    MetricsSettings settings;
+    int listener = -1;
+    std::thread thread;
+    std::atomic<bool> running{false};
+};
+
+#endif // METRICS_EXPORTER_HPP
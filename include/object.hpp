@@ -1,35 +1,36 @@
 #ifndef OBJECT_HPP
 #define OBJECT_HPP
 
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
+#include <cstdint>
 
 enum class ObjectType {
     BALL,
     BOX
 };
 
+// Reference to an object in an ObjectPool. A handle to a destroyed object is
+// detected because its slot's generation has moved on. Generation 0 is never
+// used, so a zero-initialised handle refers to nothing.
+struct ObjectHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool operator==(const ObjectHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const ObjectHandle& other) const { return !(*this == other); }
+};
+
 class Object {
 public:
     ObjectType type;
     float x, y;   // Position
     float vx, vy; // Velocity
+    ObjectHandle handle; // Set by the ObjectPool that owns the object
 
     Object(ObjectType t, float x, float y, float vx, float vy)
         : type(t), x(x), y(y), vx(vx), vy(vy)
     {}
 
     virtual ~Object() {}
-
-    // Update the physics state for delta time dt.
-    virtual void updatePhysics(float dt) = 0;
-    // Render the object.
-    virtual void render(SDL_Renderer* renderer) const = 0;
-    // Optionally, render additional info (e.g. velocity text). Default does nothing.
-    virtual void renderVelocityInfo(SDL_Renderer* renderer, TTF_Font* font) const {}
-
-    // Add this method if not already present
-    virtual SDL_Rect getBoundingBox() const = 0;
 };
 
 #endif // OBJECT_HPP
\ No newline at end of file
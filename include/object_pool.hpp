@@ -0,0 +1,85 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include "object.hpp"
+#include "ball.hpp"
+#include "box.hpp"
+
+// Chunked storage for Balls and Boxes.
+//
+// Objects live in fixed-size chunks that are never moved or freed, so an
+// object's address is stable for its whole life. Destroyed slots go on a free
+// list and are reused by later spawns, which makes create and destroy
+// allocation-free except when a new chunk is needed.
+class ObjectPool {
+public:
+    static constexpr size_t CHUNK_SIZE = 1024;
+
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+    ~ObjectPool() { clear(); }
+
+    // Construct a T (Ball or Box) in a free slot.
+    template <typename T, typename... Args>
+    ObjectHandle create(Args&&... args);
+
+    // Destroy the object; its handle becomes stale. Returns false if it already was.
+    bool destroy(ObjectHandle handle);
+
+    // The object, or null if the handle is stale.
+    Object* get(ObjectHandle handle) const;
+
+    // Make sure `count` objects fit without allocating.
+    void reserve(size_t count);
+
+    // Destroy every object. Chunks are kept for reuse.
+    void clear();
+
+    // Number of live objects.
+    size_t size() const { return liveCount; }
+    // Number of objects that fit without allocating.
+    size_t capacity() const { return chunks.size() * CHUNK_SIZE; }
+
+private:
+    static constexpr size_t SLOT_SIZE = sizeof(Ball) > sizeof(Box) ? sizeof(Ball) : sizeof(Box);
+    static constexpr size_t SLOT_ALIGN = alignof(Ball) > alignof(Box) ? alignof(Ball) : alignof(Box);
+
+    struct Slot {
+        typename std::aligned_storage<SLOT_SIZE, SLOT_ALIGN>::type storage;
+        Object* object = nullptr; // Null while the slot is free
+        uint32_t generation = 1;
+    };
+
+    Slot& slotAt(uint32_t index) const { return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE]; }
+    uint32_t allocateSlot();
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    std::vector<uint32_t> freeSlots;
+    uint32_t usedSlots = 0; // Slots handed out at least once
+    size_t liveCount = 0;
+};
+
+template <typename T, typename... Args>
+ObjectHandle ObjectPool::create(Args&&... args) {
+    static_assert(std::is_base_of<Object, T>::value, "ObjectPool only stores Objects");
+    static_assert(sizeof(T) <= SLOT_SIZE && alignof(T) <= SLOT_ALIGN, "Object does not fit into a slot");
+
+    uint32_t index = allocateSlot();
+    Slot& slot = slotAt(index);
+    T* object = new (&slot.storage) T(std::forward<Args>(args)...);
+    slot.object = object;
+    object->handle.index = index;
+    object->handle.generation = slot.generation;
+    liveCount++;
+    return object->handle;
+}
+
+#endif // OBJECT_POOL_HPP
@@ -0,0 +1,72 @@
+#ifndef PERF_HUD_HPP
+#define PERF_HUD_HPP
+
+#include <vector>
+#include <cstddef>
+#include "command_buffer.hpp"
+#include "text_renderer.hpp"
+#include "physics_stats.hpp"
+#include "lock_stats.hpp"
+
+// Rolling graphs of frame and physics statistics, drawn over the scene.
+//
+// One sample of every series is taken per frame, from the frame time and the
+// PhysicsStats of the latest snapshot. A graph is recorded as connected LINE
+// commands of one colour on a blended FILL_RECT panel, so the RenderQueue
+// draws all panels with one FillRects call and each graph with one DrawLines
+// call, whatever the history length.
+//
+// Given the world's LockStats, a second column shows per lock site the wait
+// and hold time histograms of the last second as FILL_RECT bars.
+class PerfHud {
+public:
+    // Samples shown per graph.
+    static constexpr size_t HISTORY = 240;
+    // Width of the overlay, in pixels.
+    static constexpr float WIDTH = 360.0f;
+
+    PerfHud();
+
+    void addSample(float frameMs, const PhysicsStats& physics, const LockStats* locks = nullptr);
+    // Record the graphs into the HUD layer with the top-left corner at (x, y);
+    // the lock histograms go to the left of them.
+    void record(CommandBuffer& commands, const TextRenderer& text, float x, float y) const;
+
+private:
+    enum Series {
+        FRAME_MS,
+        INTEGRATE_MS,
+        DETECT_MS,
+        SOLVE_MS,
+        STEPS_PER_SECOND,
+        OBJECTS,
+        CONTACTS,
+        MUTEX_WAIT_MS,
+        SERIES_COUNT
+    };
+
+    // Sample i of a series, oldest first.
+    float sample(Series series, size_t i) const;
+    // Sum of the series first..last of sample i, for stacked graphs.
+    float stacked(Series first, Series last, size_t i) const;
+    // Record one panel. Series first..last are stacked, each in its colour.
+    // Returns the height of the panel.
+    float recordGraph(CommandBuffer& commands, const TextRenderer& text, float x, float y, const char* label,
+                      const char* unit, Series first, Series last, const SDL_Color* colors) const;
+    // Record the lock histograms. Returns the height of the panel.
+    float recordLocks(CommandBuffer& commands, const TextRenderer& text, float x, float y) const;
+
+    std::vector<float> samples[SERIES_COUNT]; // Ring buffers of HISTORY samples
+    size_t next = 0;
+    size_t count = 0;
+
+    // World lock counts of the last complete window, and at the start of the
+    // current one.
+    LockStats::Counts lockWindow[LOCK_SITES] = {};
+    LockStats::Counts lockStart[LOCK_SITES] = {};
+    float lockWindowMs = 0.0f;
+    float lockElapsedMs = 0.0f;
+    bool hasLocks = false;
+};
+
+#endif // PERF_HUD_HPP
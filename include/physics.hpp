@@ -3,10 +3,76 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
 #include "object.hpp"
+#include "world.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+#include "contact_solver.hpp"
+#include "xpbd.hpp"
+#include "physics_stats.hpp"
+#include "metrics.hpp"
 
-// The physics thread function updates all objects and resolves collisions.
-// The vector contains pointers to dynamically allocated Object (Ball or Box).
-void physicsThreadFunction(bool &running, std::vector<Object*> &objects, std::mutex &objectsMutex);
+// How collisions are handled.
+// - IMPULSE: velocity impulses with tiny (1 ms) steps.
+// - XPBD: position based contacts with substeps, stable with 1/60 s steps.
+enum class SolverMode {
+    IMPULSE,
+    XPBD
+};
 
-#endif // PHYSICS_HPP
\ No newline at end of file
+// Settings that may be changed while the physics thread is running.
+struct PhysicsSettings {
+    std::atomic<SolverMode> solverMode{SolverMode::IMPULSE};
+    // Worker threads used by the physics step (0 = hardware concurrency).
+    // Only read when the physics thread starts.
+    unsigned threads = 0;
+    // Receives step times and object counts if set. Only read when the
+    // physics thread starts.
+    Metrics* metrics = nullptr;
+};
+
+// Advances the objects in fixed steps.
+//
+// A step only depends on the objects, the solver mode, the world bounds and the world parameters: every parallel phase
+// splits its work in a way that does not depend on the number of threads, so
+// the same scene stepped the same number of times gives bit-identical results
+// on any number of workers.
+class PhysicsStepper {
+public:
+    explicit PhysicsStepper(unsigned threads = 0);
+
+    // Advance all objects by one step of the given mode.
+    void step(std::vector<Object*> &objects, SolverMode mode, const WorldBounds &bounds, const WorldParams &params);
+    // Length of one step of the given mode, in seconds.
+    static float stepSize(SolverMode mode);
+    // Steps taken so far.
+    uint64_t stepCount() const { return steps; }
+    // Continue counting from a restored checkpoint.
+    void setStepCount(uint64_t count) { steps = count; }
+    // Phase times of the last step.
+    const StepTimes& lastTimes() const { return times; }
+    // Contacts found by the last step.
+    size_t contactCount() const { return contacts; }
+    // Worker threads of the stepper, for other parallel work between steps.
+    ThreadPool& threadPool() { return pool; }
+
+private:
+    ThreadPool pool;
+    ContactSolver solver;
+    XPBDSolver xpbd;
+    uint64_t steps;
+    StepTimes times;
+    size_t contacts = 0;
+};
+
+// Hash of the exact bits of every object's type, position and velocity.
+// Two runs are identical as long as their hashes match after every step.
+uint64_t hashObjects(const std::vector<Object*> &objects);
+
+// The physics thread function updates all objects of the world and resolves collisions.
+// After stepping, a copy of the objects is published to snapshots for queries.
+void physicsThreadFunction(bool &running, World &world, PhysicsSettings &settings, SnapshotBuffer &snapshots);
+
+#endif // PHYSICS_HPP
@@ -0,0 +1,33 @@
+#ifndef PHYSICS_STATS_HPP
+#define PHYSICS_STATS_HPP
+
+#include <cstdint>
+#include <chrono>
+
+// Seconds on a monotonic clock, for timing phases.
+inline double phaseClock() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Seconds spent in each phase of one physics step.
+struct StepTimes {
+    double integrate = 0.0; // Moving the balls and the wall pass
+    double detect = 0.0;    // Finding and colouring contacts
+    double solve = 0.0;     // Resolving contacts
+
+    double total() const { return integrate + detect + solve; }
+};
+
+// What the physics thread did since the previous snapshot. Published with
+// every snapshot so the render thread can show it without touching the world.
+struct PhysicsStats {
+    float integrateMs = 0.0f; // Mean time per step of each phase
+    float detectMs = 0.0f;
+    float solveMs = 0.0f;
+    float mutexWaitMs = 0.0f; // Mean wait for world.mutex per step
+    float stepsPerSecond = 0.0f;
+    uint32_t objects = 0;
+    uint32_t contacts = 0;    // Contacts found by the last step
+};
+
+#endif // PHYSICS_STATS_HPP
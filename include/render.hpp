@@ -2,11 +2,16 @@
 #define RENDER_HPP
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
-#include "object.hpp"
+#include "spatial_index.hpp"
+#include "command_buffer.hpp"
+#include "text_renderer.hpp"
+#include "camera.hpp"
 
-// A helper that calls the object's render() method.
-void renderObject(SDL_Renderer* renderer, const Object* obj);
-void renderDebugInfo(SDL_Renderer* renderer, TTF_Font* font, const Object* obj);
+// Helpers that record how a snapshotted object is drawn through a camera.
+// text is only used to measure labels.
+SDL_Rect boundingBox(const Camera& camera, const ObjectState& obj);
+void recordObject(CommandBuffer& commands, const Camera& camera, const ObjectState& obj, CircleStyle ballStyle);
+void recordVelocityInfo(CommandBuffer& commands, const TextRenderer& text, const Camera& camera, const ObjectState& obj);
+void recordDebugInfo(CommandBuffer& commands, const TextRenderer& text, const Camera& camera, const ObjectState& obj);
 
-#endif // RENDER_HPP
\ No newline at end of file
+#endif // RENDER_HPP
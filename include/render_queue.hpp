@@ -0,0 +1,64 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <cstdint>
+#include "command_buffer.hpp"
+#include "circle_atlas.hpp"
+#include "circle_batch.hpp"
+#include "text_renderer.hpp"
+#include "bitmap_font.hpp"
+#include "thread_pool.hpp"
+
+// Draws a CommandBuffer with as few renderer state changes and draw calls as
+// possible.
+//
+// Commands are sorted by layer, then by kind: points, lines and rectangles
+// first, then circles, then text. Points, lines and rectangles are further
+// sorted by blend mode and colour, and every run sharing one state is drawn
+// with a single SDL_RenderDrawPoints / DrawLines / DrawRects / FillRects call.
+// Circles and text become textured quads batched per texture, with one
+// SDL_RenderGeometry call each. Commands that compare equal keep their
+// recorded order, so shadows stay under their text and connected line
+// segments stay connected.
+class RenderQueue {
+public:
+    // Upload the font atlas. Must be called on the thread that owns renderer.
+    bool init(SDL_Renderer* renderer, const BitmapFont& font);
+    // Free all textures. Must be called before the renderer is destroyed.
+    void releaseTextures();
+
+    // Font metrics, for measuring labels while recording.
+    const TextRenderer& text() const { return textBatch; }
+
+    // Draw every command. spriteCircles picks the anti-aliased sprite atlas
+    // over triangle meshes for circles up to CircleAtlas::MAX_SPRITE_RADIUS.
+    // pool may be null.
+    void execute(SDL_Renderer* renderer, const CommandBuffer& commands, bool spriteCircles, ThreadPool* pool);
+
+private:
+    struct Item {
+        uint64_t key;
+        uint32_t index; // Into the command list
+    };
+
+    void setState(SDL_Renderer* renderer, SDL_BlendMode blend, SDL_Color color);
+    void drawRun(SDL_Renderer* renderer, const std::vector<DrawCommand>& list, size_t begin, size_t end);
+    void flushGeometry(SDL_Renderer* renderer, ThreadPool* pool);
+
+    std::vector<Item> order;
+    std::vector<SDL_Point> points;
+    std::vector<SDL_Rect> rects;
+
+    // Renderer state set by the last setState, if still valid.
+    bool stateValid = false;
+    SDL_BlendMode currentBlend = SDL_BLENDMODE_NONE;
+    SDL_Color currentColor = {0, 0, 0, 0};
+
+    CircleAtlas sprites;
+    CircleBatch outlineMeshes, filledMeshes;
+    TextRenderer textBatch;
+};
+
+#endif // RENDER_QUEUE_HPP
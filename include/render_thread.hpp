@@ -0,0 +1,69 @@
+#ifndef RENDER_THREAD_HPP
+#define RENDER_THREAD_HPP
+
+#include <SDL2/SDL.h>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include "world_bounds.hpp"
+#include "snapshot.hpp"
+#include "scene_renderer.hpp"
+#include "thread_pool.hpp"
+#include "frame_pacer.hpp"
+#include "perf_hud.hpp"
+#include "metrics.hpp"
+
+// Draws frames on its own thread so presenting (and waiting for vsync) never
+// delays event handling.
+//
+// Every frame the thread draws the latest published WorldSnapshot with the
+// current ViewState through a SceneRenderer. The renderer and all textures
+// are created, used and destroyed on this thread. Frames are paced by a
+// FramePacer, whose frame-time statistics are shown in the HUD. Frame times
+// and the physics statistics of the snapshots feed the PerfHud graphs, and
+// frame times the Metrics if given. With the world's LockStats, the PerfHud
+// also shows the world lock histograms.
+class RenderThread {
+public:
+    RenderThread(SDL_Window* window, const WorldBounds& bounds, SnapshotBuffer& snapshots,
+                 PacingMode pacing = PacingMode::VSYNC, double targetFps = 0.0, Metrics* metrics = nullptr,
+                 const LockStats* locks = nullptr);
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Start drawing. Returns false if the renderer could not be set up.
+    bool start();
+    void stop();
+
+    // Main thread: state to draw the next frame with.
+    void setView(const ViewState& state);
+
+private:
+    void run(std::promise<bool>* started);
+    bool init();
+    void shutdown();
+
+    SDL_Window* window;
+    SnapshotBuffer& snapshots;
+    Metrics* metrics;
+    const LockStats* locks;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    std::mutex viewMutex;
+    ViewState view;
+
+    // Owned by the render thread while it runs.
+    SDL_Renderer* renderer = nullptr;
+    ThreadPool pool;
+    SceneRenderer scene;
+    FramePacer pacer;
+    FrameStats stats;
+    PerfHud perfHud;
+    Uint32 statsTimer = 0;
+};
+
+#endif // RENDER_THREAD_HPP
@@ -0,0 +1,85 @@
+#ifndef SCENE_FILE_HPP
+#define SCENE_FILE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "world.hpp"
+#include "world_bounds.hpp"
+
+// Binary scene files.
+//
+// A scene is a header followed by an array of balls, one of boxes and, per
+// box, the number of balls saved before it. Each array starts on a 64 byte
+// boundary and holds plain little-endian values. The file is mapped and the
+// records are copied into the world's pool in one pass that also validates
+// them; the box positions merge both arrays back into the saved order.
+struct SceneHeader {
+    static constexpr uint32_t MAGIC = 0x4353504A; // "JPSC"
+    static constexpr uint32_t VERSION = 2;
+
+    uint32_t magic;
+    uint32_t version;
+    float worldWidth, worldHeight;
+    uint64_t ballCount, ballOffset; // Offsets are from the start of the file
+    uint64_t boxCount, boxOffset;
+    uint64_t boxOrderOffset;        // boxCount balls-before counts, non-decreasing
+};
+
+struct SceneBall {
+    float x, y;
+    float vx, vy;
+    float radius;
+};
+
+struct SceneBox {
+    float x, y; // Centre
+    float width, height;
+};
+
+static_assert(sizeof(SceneHeader) == 56, "SceneHeader must have no padding");
+static_assert(sizeof(SceneBall) == 20 && sizeof(SceneBox) == 16, "Scene records must have no padding");
+
+// A scene file mapped read-only into memory.
+class SceneFile {
+public:
+    SceneFile() = default;
+    ~SceneFile();
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    // Map and validate the file. On failure error says why.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const SceneHeader& header() const { return *static_cast<const SceneHeader*>(data); }
+    const SceneBall* balls() const;
+    const SceneBox* boxes() const;
+    // Number of balls before each box in the saved order.
+    const uint64_t* boxOrder() const;
+
+private:
+    void* data = nullptr;
+    size_t size = 0;
+};
+
+// Write a scene file; boxOrder holds the number of balls before each box.
+// Returns false on I/O errors.
+bool writeScene(const std::string& path, const WorldBounds& bounds, const std::vector<SceneBall>& balls,
+                const std::vector<SceneBox>& boxes, const std::vector<uint64_t>& boxOrder);
+// Write every object of the world; the caller holds world.mutex.
+bool saveScene(const std::string& path, const World& world);
+// Replace the world's objects and bounds with a scene file's. The caller
+// holds world.mutex. On failure the world is unchanged and error says why.
+// Objects with non-finite values or sizes that are not positive are skipped
+// with a warning.
+bool loadScene(const std::string& path, World& world, std::string& error);
+// Add scene records to the world. Box i comes after boxOrder[i] balls;
+// without boxOrder the boxes come first. The caller holds world.mutex.
+// Invalid records are skipped; returns how many.
+size_t spawnSceneObjects(World& world, const SceneBall* balls, size_t ballCount, const SceneBox* boxes,
+                         size_t boxCount, const uint64_t* boxOrder = nullptr);
+
+#endif // SCENE_FILE_HPP
@@ -0,0 +1,38 @@
+#ifndef SCENE_GENERATOR_HPP
+#define SCENE_GENERATOR_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "scene_file.hpp"
+#include "thread_pool.hpp"
+#include "world_bounds.hpp"
+
+// Repeatable stress scenes for benchmarks and capacity planning.
+enum class SceneKind {
+    RAIN,      // Balls falling from the upper half of the world
+    HEX,       // A hexagonally packed pile resting on the floor
+    PYRAMIDS,  // Pyramids of balls standing on boxes
+    AVALANCHE, // A block of balls pouring through a maze of boxes
+    GAS        // Small balls flying in every direction at high speed
+};
+
+// Objects of a generated scene, in the records of the scene file format.
+struct GeneratedScene {
+    std::vector<SceneBall> balls;
+    std::vector<SceneBox> boxes;
+};
+
+// Generate count balls (and the boxes the kind needs) laid out to fill bounds.
+// Balls shrink as count grows, so any count fits. The scene depends only on
+// kind, count, seed and bounds: every ball draws its own random numbers, so
+// balls are generated in parallel with the same result on any number of
+// threads.
+void generateScene(SceneKind kind, size_t count, uint32_t seed, const WorldBounds& bounds, ThreadPool& pool,
+                   GeneratedScene& scene);
+
+bool parseSceneKind(const std::string& name, SceneKind& kind);
+const char* sceneKindName(SceneKind kind);
+
+#endif // SCENE_GENERATOR_HPP
@@ -0,0 +1,91 @@
+#ifndef SCENE_RENDERER_HPP
+#define SCENE_RENDERER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "object.hpp"
+#include "camera.hpp"
+#include "world_bounds.hpp"
+#include "snapshot.hpp"
+#include "command_buffer.hpp"
+#include "render_queue.hpp"
+#include "tile_rasterizer.hpp"
+#include "density_map.hpp"
+#include "thread_pool.hpp"
+#include "perf_hud.hpp"
+
+// How balls too small to draw as circles are shown.
+enum class LodMode {
+    OFF,     // Circles regardless of size
+    POINTS,  // One point per ball
+    HEATMAP  // Balls per pixel as a colour
+};
+
+// What to show besides the objects, and through which camera.
+struct ViewState {
+    bool showVelocityInfo = false; // Velocity labels above balls
+    bool debugMode = false;        // Bounding boxes and state labels
+    bool filledBalls = false;
+    bool spriteBalls = true;       // Anti-aliased sprites instead of triangle meshes
+    bool cpuRaster = false;        // Objects drawn by the TileRasterizer
+    LodMode lod = LodMode::HEATMAP;
+    bool xpbd = false;             // Shown in the HUD
+    bool perfHud = false;          // Performance graphs
+    Camera camera;
+
+    // Mouse drag used to spawn objects, in window pixels.
+    bool dragging = false;
+    bool previewBoxMode = false;
+    int dragStartX = 0, dragStartY = 0;
+    int currentDragX = 0, currentDragY = 0;
+
+    ObjectHandle selectedObject;
+};
+
+// Draws a WorldSnapshot into any SDL renderer, on screen or offscreen.
+//
+// A frame is recorded into a CommandBuffer and drawn with a RenderQueue. Only
+// objects the snapshot's spatial index finds inside the camera's view are
+// recorded, so the cost of a frame follows what is visible; beyond a fixed
+// budget only a sample of the visible objects is drawn. With cpuRaster
+// set, balls and boxes are drawn by a TileRasterizer instead and only the
+// overlays go through the queue. All calls must come from the thread that
+// owns the renderer.
+//
+// Balls whose radius on screen is below a pixel are left out of both and
+// drawn as points or as a DensityMap, depending on the view's LodMode.
+class SceneRenderer {
+public:
+    explicit SceneRenderer(const WorldBounds& bounds);
+
+    // Upload the embedded font. Returns false on failure.
+    bool init(SDL_Renderer* renderer);
+    // Free all textures. Must be called before the renderer is destroyed.
+    void releaseTextures();
+
+    // Clear the target and draw the snapshot (which may be null), the view's
+    // overlays and hudText in the top-left corner. pool may be null. With
+    // view.perfHud set, perfHud (if not null) is drawn in the top-right corner.
+    void draw(SDL_Renderer* renderer, const WorldSnapshot* snapshot, const ViewState& view,
+              const char* hudText, ThreadPool* pool, const PerfHud* perfHud = nullptr);
+
+private:
+    void findVisible(const WorldSnapshot& snapshot, const Camera& camera);
+    void splitBySize(const WorldSnapshot& snapshot, const Camera& camera);
+    void record(const WorldSnapshot* snapshot, const ViewState& state, const char* hudText, bool recordObjects,
+                const PerfHud* perfHud);
+
+    WorldBounds bounds;
+    CommandBuffer commands;
+    RenderQueue queue;
+    TileRasterizer rasterizer;
+    DensityMap densityMap;
+    std::vector<size_t> visible;  // Snapshot indices inside the view
+    std::vector<size_t> detailed; // Visible objects drawn at full detail
+    std::vector<size_t> tiny;     // Visible balls below the LOD size
+    const std::vector<size_t>* drawn = &visible;
+    size_t sampleStride = 1;      // Visible objects per object in `visible`
+    int viewWidth = 0, viewHeight = 0;
+};
+
+#endif // SCENE_RENDERER_HPP
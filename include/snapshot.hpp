@@ -0,0 +1,54 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "object.hpp"
+#include "spatial_index.hpp"
+#include "physics_stats.hpp"
+
+// State of every object at the end of a physics step. Once published it is
+// never modified, so other threads can read and query it without taking
+// objectsMutex.
+class WorldSnapshot {
+public:
+    std::vector<ObjectState> objects;
+    // How the physics thread fared since the previous snapshot.
+    PhysicsStats stats;
+
+    // Spatial index over objects. Built by buildIndex, or otherwise on first
+    // use by whichever thread asks first.
+    const SpatialIndex& index() const;
+    // Build the index now, on the pool if given. The physics thread does this
+    // before publishing, so drawing a frame never pays for indexing the whole
+    // world.
+    void buildIndex(ThreadPool* pool = nullptr);
+
+    // Replace the contents with the current state of the objects.
+    void capture(const std::vector<Object*>& source);
+
+private:
+    mutable std::mutex indexMutex;
+    mutable bool indexBuilt = false;
+    mutable SpatialIndex spatialIndex;
+};
+
+// Hands the latest snapshot from the physics thread to readers.
+// Snapshots no reader holds any more are recycled to avoid reallocating.
+class SnapshotBuffer {
+public:
+    // Physics thread: a snapshot to fill before publishing it.
+    std::shared_ptr<WorldSnapshot> acquire();
+    void publish(const std::shared_ptr<WorldSnapshot>& snapshot);
+
+    // Any thread: the most recently published snapshot, or null before the first one.
+    std::shared_ptr<const WorldSnapshot> latest() const;
+
+private:
+    mutable std::mutex mutex;
+    std::shared_ptr<WorldSnapshot> current;
+    std::vector<std::shared_ptr<WorldSnapshot>> retired;
+};
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,87 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "object.hpp"
+#include "thread_pool.hpp"
+
+// Plain copy of an object's state, taken by the physics thread at the end of a step.
+struct ObjectState {
+    ObjectType type;
+    ObjectHandle handle;  // The object this state was copied from
+    float x, y;           // Position (centre)
+    float vx, vy;         // Velocity
+    float radius;         // Balls only
+    float width, height;  // Boxes only
+};
+
+// Result of SpatialIndex::rayCast.
+struct RayHit {
+    size_t index;     // Index into the indexed states
+    float distance;   // Distance from the ray origin
+    float x, y;       // Hit point
+    float nx, ny;     // Surface normal at the hit point
+};
+
+// Uniform grid over a set of ObjectState used to answer spatial queries.
+//
+// Every object is stored in each cell its bounding box touches; very large
+// objects are kept in a separate list that every query checks. Queries return
+// indices into the vector passed to build(), in ascending order unless noted,
+// and only read the index, so any number of threads may query concurrently.
+class SpatialIndex {
+public:
+    // Index states, in parallel on the pool if given. The result is the same
+    // either way.
+    void build(const std::vector<ObjectState>& states, ThreadPool* pool = nullptr);
+
+    // Objects containing the point.
+    void queryPoint(float x, float y, std::vector<size_t>& out) const;
+    // Objects overlapping the rectangle [minX, maxX] x [minY, maxY].
+    void queryRect(float minX, float minY, float maxX, float maxY, std::vector<size_t>& out) const;
+    // Like queryRect, but in no particular order, which saves sorting the
+    // result. For view culling, where only the set matters.
+    void queryRectUnordered(float minX, float minY, float maxX, float maxY, std::vector<size_t>& out) const;
+    // Like queryRectUnordered, but if the cells in the rectangle hold more
+    // than maxItems entries, only every n-th entry is looked at, so the cost
+    // stays O(maxItems) however crowded the rectangle is. Each object is then
+    // reported with probability 1/n. Returns n; 1 means the result is exact.
+    // Large objects are always reported.
+    size_t queryRectSampled(float minX, float minY, float maxX, float maxY, size_t maxItems,
+                            std::vector<size_t>& out) const;
+    // Objects overlapping the circle.
+    void queryCircle(float x, float y, float radius, std::vector<size_t>& out) const;
+    // First object hit by the ray from (ox, oy) along (dx, dy) within maxDistance.
+    // The direction does not need to be normalised.
+    bool rayCast(float ox, float oy, float dx, float dy, float maxDistance, RayHit& hit) const;
+
+private:
+    struct Cell {
+        int x, y;
+    };
+
+    Cell cellOf(float x, float y) const;
+    void cellRange(size_t item, Cell& lo, Cell& hi) const;
+    template <typename Overlaps>
+    void queryCells(float minX, float minY, float maxX, float maxY, Overlaps overlaps, std::vector<size_t>& out,
+                    bool sorted = true) const;
+
+    const std::vector<ObjectState>* states = nullptr;
+    float originX = 0.0f, originY = 0.0f;
+    float cellSize = 1.0f, invCellSize = 1.0f;
+    int columns = 0, rows = 0;
+    std::vector<uint32_t> cellStart;  // columns * rows + 1 offsets into cellItems
+    std::vector<uint32_t> cellItems;
+    std::vector<uint32_t> largeItems; // Objects covering too many cells
+
+    // Scratch space of build, kept to avoid reallocating.
+    std::vector<Cell> ranges;         // First and last cell per object
+    std::vector<uint32_t> bandCounts; // Per chunk and band, then the chunk's next slot
+    std::vector<uint32_t> bandStart;  // Offsets into bandItems per band
+    std::vector<uint32_t> bandItems;  // Objects touching each band, ascending
+    std::vector<uint32_t> fill;       // Next free slot per cell
+};
+
+#endif // SPATIAL_INDEX_HPP
@@ -0,0 +1,40 @@
+#ifndef TEXT_RENDERER_HPP
+#define TEXT_RENDERER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "bitmap_font.hpp"
+
+// Draws text as textured quads from a BitmapFont.
+//
+// The font's atlas is uploaded once as a single texture. Strings queued with
+// add() are laid out into one vertex buffer and submitted with one
+// SDL_RenderGeometry call per frame, so labels never create surfaces or
+// textures while drawing.
+class TextRenderer {
+public:
+    // Take over the glyph metrics of font and upload its atlas.
+    bool init(SDL_Renderer* renderer, const BitmapFont& font);
+
+    // Queue text with its top-left corner at (x, y).
+    void add(const char* text, float x, float y, SDL_Color color);
+    // Size of text as add() would lay it out.
+    void measure(const char* text, int& width, int& height) const;
+    int lineHeight() const { return font.lineHeight; }
+
+    // Submit and clear everything queued since the last draw.
+    void draw(SDL_Renderer* renderer);
+
+    // Free the atlas texture. Must be called before the renderer is destroyed.
+    void releaseTexture();
+
+private:
+    BitmapFont font; // Metrics only; the coverage lives in the texture
+    SDL_Texture* texture = nullptr;
+    float invWidth = 0.0f, invHeight = 0.0f;
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+#endif // TEXT_RENDERER_HPP
@@ -0,0 +1,51 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+
+// A fixed set of worker threads used to split data-parallel loops.
+// The calling thread takes part in every parallelFor, so a pool of size 1
+// simply runs the loop inline.
+class ThreadPool {
+public:
+    // threadCount counts the caller too; 0 picks the hardware concurrency.
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads taking part in a parallelFor (workers + caller).
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Call fn(begin, end) on chunks covering [0, count). Chunks hold at least
+    // `grain` items and may run on any thread in any order, so fn must not
+    // depend on how the range is split. Returns once every chunk has run.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    bool stopping;
+    unsigned generation;
+    unsigned busyWorkers;
+
+    // The job currently being split up.
+    const std::function<void(size_t, size_t)>* job;
+    size_t jobCount;
+    size_t jobChunk;
+    std::atomic<size_t> nextIndex;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,54 @@
+#ifndef TILE_RASTERIZER_HPP
+#define TILE_RASTERIZER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <cstdint>
+#include "camera.hpp"
+#include "circle_batch.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+
+// Draws balls and boxes on the CPU and uploads the frame as one texture.
+//
+// The view is split into square tiles. Objects are first binned into every
+// tile their screen bounds touch, then the tiles are filled in parallel, one
+// row span at a time, straight into a locked streaming texture. Nothing is
+// sent to the renderer per object, so the cost no longer depends on how many
+// primitives the SDL backend can take per frame.
+class TileRasterizer {
+public:
+    ~TileRasterizer();
+
+    // Fill the whole view with the visible objects and copy it to the
+    // renderer, replacing its contents. pool may be null.
+    bool draw(SDL_Renderer* renderer, int width, int height, const std::vector<ObjectState>& objects,
+              const std::vector<size_t>& visible, const Camera& camera, CircleStyle ballStyle, ThreadPool* pool);
+    // Free the texture. Must be called before the renderer is destroyed.
+    void releaseTexture();
+
+private:
+    // One object in screen space.
+    struct Shape {
+        float x, y;          // Ball centre or box corner
+        float radius;        // Balls; zero for boxes
+        float width, height; // Boxes
+        uint32_t color;      // SDL_PIXELFORMAT_ARGB8888
+    };
+
+    bool ensureTexture(SDL_Renderer* renderer, int width, int height);
+    void bin(size_t chunk, const std::vector<ObjectState>& objects, const std::vector<size_t>& visible,
+             const Camera& camera);
+    void fillTile(size_t tile, uint8_t* pixels, int pitch, CircleStyle ballStyle) const;
+
+    SDL_Texture* texture = nullptr;
+    int textureWidth = 0, textureHeight = 0;
+    int tilesX = 0, tilesY = 0;
+
+    // Per chunk of visible objects, the shapes touching each tile. Chunks are
+    // binned in parallel and read back in order, so every tile draws its
+    // shapes in the order they were given and reads them sequentially.
+    std::vector<std::vector<std::vector<Shape>>> chunkBins;
+};
+
+#endif // TILE_RASTERIZER_HPP
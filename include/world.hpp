@@ -0,0 +1,125 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "object.hpp"
+#include "object_pool.hpp"
+#include "world_bounds.hpp"
+#include "lock_stats.hpp"
+
+// Balls slower than this on both axes are considered at rest (sleeping), in
+// pixels per second.
+constexpr float REST_SPEED = 5.0f;
+
+// Rules for removing balls automatically. A value of 0 disables the rule.
+// Boxes are scenery placed by the user and are never removed automatically.
+struct LifetimePolicy {
+    size_t maxBalls = 0;          // Beyond this the oldest balls are evicted
+    float timeToLive = 0.0f;      // Seconds a ball may exist
+    float sleepTimeout = 0.0f;    // Seconds a ball may rest before it is removed
+    float offWorldTimeout = 0.0f; // Seconds a ball may spend outside the world
+};
+
+// Everything a World needs to continue exactly where it was.
+struct WorldState {
+    // One object in simulation order, with its lifetime timers.
+    struct Entry {
+        ObjectType type;
+        float x, y;
+        float vx, vy;
+        float radius;        // Balls
+        float width, height; // Boxes
+        double spawnTime;
+        float restTime;
+        float offWorldTime;
+    };
+
+    WorldBounds bounds;
+    WorldParams params;
+    double time = 0.0;
+    std::vector<Entry> objects;
+    std::vector<uint32_t> spawnOrder; // Indices of the balls in objects, oldest first
+};
+
+// All simulated objects.
+//
+// The objects themselves live in a pool and are referred to from outside by
+// ObjectHandle. `objects` lists the live ones densely in simulation order and is
+// what the physics step iterates over. Everything here is guarded by `mutex`;
+// callers lock it around every access, like the physics thread does per step,
+// through a TimedLock on `locks` so contention shows up by call site.
+struct World {
+    ObjectPool pool;
+    std::vector<Object*> objects;
+    std::mutex mutex;
+    LockStats locks;
+
+    // Size of the world. Set before the physics thread starts.
+    WorldBounds bounds;
+    // Physical constants; may be changed between steps.
+    WorldParams params;
+    LifetimePolicy lifetime;
+    // Simulated time in seconds, advanced by updateLifetimes.
+    double time = 0.0;
+
+    ObjectHandle spawnBall(float x, float y, float vx, float vy, float radius);
+    ObjectHandle spawnBox(float x, float y, float width, float height);
+
+    // Remove an object. The last object of `objects` takes its place, so the
+    // order of `objects` changes but every handle stays valid.
+    // Returns false if the object no longer exists.
+    bool despawn(ObjectHandle handle);
+
+    // The object, or null if it no longer exists.
+    Object* get(ObjectHandle handle) const { return pool.get(handle); }
+
+    // Advance the lifetime timers by dt and remove balls according to `lifetime`.
+    void updateLifetimes(float dt);
+
+    // Number of live balls.
+    size_t ballCount() const { return balls; }
+
+    // Make room for `count` objects so that spawning does not allocate.
+    void reserve(size_t count);
+
+    // Destroy every object.
+    void clear();
+
+    // Copy the full state. Cheap enough to do under the mutex between steps.
+    void saveState(WorldState& state) const;
+    // Replace everything with a saved state. The lifetime policy is kept.
+    void restoreState(const WorldState& state);
+
+private:
+    // Lifetime bookkeeping, parallel to `objects`.
+    struct Life {
+        double spawnTime;
+        float restTime;
+        float offWorldTime;
+    };
+
+    void added(ObjectHandle handle);
+    // Make room for `count` entries in the lists parallel to `objects`.
+    void reserveDense(size_t count);
+    void evictOldest();
+    // Place in spawnOrder of entry i, counted from the oldest.
+    size_t spawnSlot(size_t i) const {
+        const size_t index = spawnFront + i;
+        return index < spawnOrder.size() ? index : index - spawnOrder.size();
+    }
+    // Drop the stale handles from spawnOrder, keeping the order.
+    void compactSpawnOrder();
+
+    std::vector<Life> lives;
+    std::vector<uint32_t> denseIndex;     // Pool slot -> index in `objects`
+    // Balls, oldest first, as a ring of spawnCount handles from spawnFront;
+    // may hold stale handles. Twice the pool's capacity, so compacting it
+    // always frees at least half.
+    std::vector<ObjectHandle> spawnOrder;
+    size_t spawnFront = 0, spawnCount = 0;
+    size_t balls = 0;
+};
+
+#endif // WORLD_HPP
@@ -0,0 +1,41 @@
+#ifndef WORLD_BOUNDS_HPP
+#define WORLD_BOUNDS_HPP
+
+#include <cstdint>
+#include <limits>
+
+// Walls that keep balls inside the world, as bits of WorldBounds::walls.
+constexpr uint8_t WALL_FLOOR   = 1;
+constexpr uint8_t WALL_CEILING = 2;
+constexpr uint8_t WALL_LEFT    = 4;
+constexpr uint8_t WALL_RIGHT   = 8;
+constexpr uint8_t WALLS_ALL    = WALL_FLOOR | WALL_CEILING | WALL_LEFT | WALL_RIGHT;
+
+// Size of the simulated area in world units (pixels at zoom 1). Balls are kept
+// inside by walls at x = 0 and x = width, a ceiling at y = 0 and the floor at
+// y = height; each of them may be left open. The window only shows the part
+// the camera looks at.
+struct WorldBounds {
+    float width = 800.0f;
+    float height = 600.0f;
+    uint8_t walls = WALLS_ALL;
+
+    bool hasWall(uint8_t wall) const { return (walls & wall) != 0; }
+};
+
+// Wall positions for the boundary pass. An open wall is moved to infinity,
+// so a ball never touches it and the pass needs no test per wall.
+struct WallLimits {
+    float left, right;
+    float top, bottom;
+
+    explicit WallLimits(const WorldBounds& bounds) {
+        const float inf = std::numeric_limits<float>::infinity();
+        left = bounds.hasWall(WALL_LEFT) ? 0.0f : -inf;
+        right = bounds.hasWall(WALL_RIGHT) ? bounds.width : inf;
+        top = bounds.hasWall(WALL_CEILING) ? 0.0f : -inf;
+        bottom = bounds.hasWall(WALL_FLOOR) ? bounds.height : inf;
+    }
+};
+
+#endif // WORLD_BOUNDS_HPP
@@ -0,0 +1,40 @@
+#ifndef WORLD_PARAMS_HPP
+#define WORLD_PARAMS_HPP
+
+#include <utility>
+
+// Physical constants of a world. Read by every step, so they may be changed
+// between two steps.
+struct WorldParams {
+    float gravity = 980.0f;            // Downward acceleration
+    float airDrag = 0.1f;              // Share of the velocity lost per second
+    float groundFriction = 500.0f;     // Deceleration of balls sliding on the floor
+    float bounceDamping = 0.7f;        // Share of the normal velocity kept by a bounce
+    float frictionCoefficient = 0.2f;  // Tangential friction between objects
+
+    bool hasGravity() const { return gravity != 0.0f; }
+    bool hasDrag() const { return airDrag != 0.0f; }
+    bool hasFriction() const { return groundFriction != 0.0f || frictionCoefficient != 0.0f; }
+};
+
+// Run Kernel<Gravity, Drag, Friction>::run(args...) with the flags of params.
+//
+// Step kernels are written once as templates. The terms a world does not
+// have compile away, and the variant is picked here once per loop instead of
+// being tested per object.
+template <template <bool, bool, bool> class Kernel, typename... Args>
+void dispatchKernel(const WorldParams& params, Args&&... args) {
+    const int variant = (params.hasGravity() ? 4 : 0) | (params.hasDrag() ? 2 : 0) | (params.hasFriction() ? 1 : 0);
+    switch (variant) {
+        case 0: Kernel<false, false, false>::run(std::forward<Args>(args)...); break;
+        case 1: Kernel<false, false, true>::run(std::forward<Args>(args)...); break;
+        case 2: Kernel<false, true, false>::run(std::forward<Args>(args)...); break;
+        case 3: Kernel<false, true, true>::run(std::forward<Args>(args)...); break;
+        case 4: Kernel<true, false, false>::run(std::forward<Args>(args)...); break;
+        case 5: Kernel<true, false, true>::run(std::forward<Args>(args)...); break;
+        case 6: Kernel<true, true, false>::run(std::forward<Args>(args)...); break;
+        default: Kernel<true, true, true>::run(std::forward<Args>(args)...); break;
+    }
+}
+
+#endif // WORLD_PARAMS_HPP
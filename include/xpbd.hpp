@@ -0,0 +1,62 @@
+#ifndef XPBD_HPP
+#define XPBD_HPP
+
+#include <vector>
+#include <cstdint>
+#include "object.hpp"
+#include "world_bounds.hpp"
+#include "contact_solver.hpp"
+#include "thread_pool.hpp"
+#include "physics_stats.hpp"
+
+// Settings for the position based solver.
+struct XPBDSettings {
+    // Substeps per step. Each substep integrates, projects every contact once
+    // and then fixes up the velocities.
+    int substeps = 10;
+    // Contact compliance (inverse stiffness). 0 makes contacts rigid.
+    float compliance = 0.0f;
+};
+
+// Extended position based dynamics solver (XPBD, "small steps" variant).
+//
+// Ball-ball and ball-box contacts are position constraints instead of impulses,
+// so piles stay at rest with large steps (1/60 s) instead of slowly sinking.
+// Contacts are detected and coloured once per step and reused by every substep;
+// each colour is projected in parallel just like ContactSolver::solve.
+class XPBDSolver {
+public:
+    void step(std::vector<Object*>& objects, float dt, const WorldBounds& bounds, const WorldParams& params,
+              ThreadPool& pool);
+
+    // Phase times of the last step; solve covers projection and velocities.
+    const StepTimes& lastTimes() const { return times; }
+    // Contacts found by the last step.
+    size_t contactCount() const { return contacts.contacts().size(); }
+
+    XPBDSettings settings;
+
+private:
+    // Per-contact state of the current substep.
+    struct ContactState {
+        float nx, ny;   // Normal pointing from a to b (or out of the box)
+        float lambda;   // Normal Lagrange multiplier
+        float vnBefore; // Normal velocity before the substep
+    };
+
+    void integrate(std::vector<Object*>& objects, float h, const WorldParams& params, ThreadPool& pool);
+    void projectContacts(std::vector<Object*>& objects, float h, ThreadPool& pool);
+    void projectWalls(std::vector<Object*>& objects, const WorldBounds& bounds, ThreadPool& pool);
+    void updateVelocities(std::vector<Object*>& objects, float h, ThreadPool& pool);
+    void solveVelocities(std::vector<Object*>& objects, float h, const WorldParams& params, ThreadPool& pool);
+    template <typename Fn> void forEachColour(ThreadPool& pool, Fn fn);
+
+    ContactSolver contacts;
+    StepTimes times;
+    std::vector<ContactState> states;
+    std::vector<float> prevX, prevY;
+    std::vector<float> prevVx, prevVy;
+    std::vector<uint8_t> wallHits;
+};
+
+#endif // XPBD_HPP
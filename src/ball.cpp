@@ -1,18 +1,11 @@
 #include "ball.hpp"
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
 #include <cmath>
 #include <algorithm>
-
-constexpr int WINDOW_WIDTH = 800;
-constexpr int WINDOW_HEIGHT = 600;
-constexpr float GRAVITY = 980.0f;
-constexpr float AIR_DRAG = 0.1f;
-constexpr float GROUND_FRICTION = 500.0f;
-constexpr float BOUNCE_DAMPING = 0.7f;
+#include <vector>
 
 // RK4 integration helper function.
-static void RK4Step(float &pos, float &vel, float dt, float (*acceleration)(const float, const float)) {
+template <typename Acceleration>
+static void RK4Step(float &pos, float &vel, float dt, Acceleration acceleration) {
     float k1_v = acceleration(pos, vel);
     float k1_x = vel;
 
@@ -32,98 +25,86 @@ static void RK4Step(float &pos, float &vel, float dt, float (*acceleration)(cons
     vel += dt / 6.0f * (k1_v + 2.0f*k2_v + 2.0f*k3_v + k4_v);
 }
 
-// Acceleration functions: horizontal (drag only) and vertical (gravity and drag).
-static float accelerationX(const float, const float v) {
-    return -AIR_DRAG * v;
-}
-
-static float accelerationY(const float, const float v) {
-    return GRAVITY - AIR_DRAG * v;
-}
-
-void Ball::updatePhysics(float dt) {
-    RK4Step(x, vx, dt, accelerationX);
-    RK4Step(y, vy, dt, accelerationY);
-
-    float half = radius;
-    // Floor collision
-    if (y + half > WINDOW_HEIGHT) {
-        y = WINDOW_HEIGHT - half;
-        vy = -vy * BOUNCE_DAMPING;
-        float frictionDelta = GROUND_FRICTION * dt;
-        if (std::fabs(vx) < frictionDelta)
-            vx = 0;
+// Move one ball by one step. Without drag the acceleration is constant and
+// the motion is integrated exactly instead of with RK4.
+template <bool Gravity, bool Drag>
+static void integrateBall(Ball& ball, float dt, const WorldParams& params) {
+    const float gravity = Gravity ? params.gravity : 0.0f;
+    if (Drag) {
+        const float drag = params.airDrag;
+        // Horizontal: drag only. Vertical: gravity and drag.
+        RK4Step(ball.x, ball.vx, dt, [drag](float, float v) { return -drag * v; });
+        if (Gravity)
+            RK4Step(ball.y, ball.vy, dt, [gravity, drag](float, float v) { return gravity - drag * v; });
         else
-            vx -= (vx > 0 ? frictionDelta : -frictionDelta);
-    }
-    // Ceiling collision
-    if (y - half < 0) {
-        y = half;
-        vy = -vy * BOUNCE_DAMPING;
-    }
-    // Left wall collision
-    if (x - half < 0) {
-        x = half;
-        vx = -vx * BOUNCE_DAMPING;
-    }
-    // Right wall collision
-    if (x + half > WINDOW_WIDTH) {
-        x = WINDOW_WIDTH - half;
-        vx = -vx * BOUNCE_DAMPING;
+            RK4Step(ball.y, ball.vy, dt, [drag](float, float v) { return -drag * v; });
+    } else {
+        ball.x += ball.vx * dt;
+        if (Gravity) {
+            ball.y += ball.vy * dt + 0.5f * gravity * dt * dt;
+            ball.vy += gravity * dt;
+        } else {
+            ball.y += ball.vy * dt;
+        }
     }
 }
 
-void Ball::render(SDL_Renderer* renderer) const {
-    int centerX = static_cast<int>(x);
-    int centerY = static_cast<int>(y);
-    int r = static_cast<int>(radius);
-    int dx = r - 1, dy = 0;
-    int err = dx - (r << 1);
-    while (dx >= dy) {
-        SDL_RenderDrawPoint(renderer, centerX + dx, centerY + dy);
-        SDL_RenderDrawPoint(renderer, centerX + dy, centerY + dx);
-        SDL_RenderDrawPoint(renderer, centerX - dy, centerY + dx);
-        SDL_RenderDrawPoint(renderer, centerX - dx, centerY + dy);
-        SDL_RenderDrawPoint(renderer, centerX - dx, centerY - dy);
-        SDL_RenderDrawPoint(renderer, centerX - dy, centerY - dx);
-        SDL_RenderDrawPoint(renderer, centerX + dy, centerY - dx);
-        SDL_RenderDrawPoint(renderer, centerX + dx, centerY - dy);
-        if (err <= 0) {
-            dy++;
-            err += dy * 2 + 1;
-        }
-        if (err > 0) {
-            dx--;
-            err -= dx * 2 + 1;
-        }
+// Bounce a ball off the walls it has crossed. Every wall is a compare and
+// selects instead of a branch, and open walls sit at infinity, so the pass
+// costs the same for every ball and wall mode. The walls still act in the
+// order floor, ceiling, left, right.
+template <bool Friction>
+static void bounceOffWalls(Ball& ball, const WallLimits& walls, float dt, const WorldParams& params) {
+    const float damping = params.bounceDamping;
+    const float half = ball.radius;
+    float x = ball.x, y = ball.y;
+    float vx = ball.vx, vy = ball.vy;
+
+    // Floor; balls sliding on it are slowed down.
+    const bool floor = y + half > walls.bottom;
+    y = floor ? walls.bottom - half : y;
+    vy = floor ? -vy * damping : vy;
+    if (Friction) {
+        const float frictionDelta = params.groundFriction * dt;
+        const float slowed = std::fabs(vx) < frictionDelta ? 0.0f : vx - (vx > 0 ? frictionDelta : -frictionDelta);
+        vx = floor ? slowed : vx;
     }
+    // Ceiling
+    const bool ceiling = y - half < walls.top;
+    y = ceiling ? walls.top + half : y;
+    vy = ceiling ? -vy * damping : vy;
+    // Left wall
+    const bool left = x - half < walls.left;
+    x = left ? walls.left + half : x;
+    vx = left ? -vx * damping : vx;
+    // Right wall
+    const bool right = x + half > walls.right;
+    x = right ? walls.right - half : x;
+    vx = right ? -vx * damping : vx;
+
+    ball.x = x;
+    ball.y = y;
+    ball.vx = vx;
+    ball.vy = vy;
 }
 
-void Ball::renderVelocityInfo(SDL_Renderer* renderer, TTF_Font* font) const {
-    std::stringstream ss;
-    ss << "v: (" << static_cast<int>(vx) << ", " << static_cast<int>(vy) << ")";
-    SDL_Color white = {255, 255, 255, 255};
-    SDL_Surface* surface = TTF_RenderText_Solid(font, ss.str().c_str(), white);
-    if (surface) {
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-        if (texture) {
-            SDL_Rect rect;
-            rect.x = static_cast<int>(x - surface->w / 2);
-            rect.y = static_cast<int>(y - radius - surface->h - 2);
-            rect.w = surface->w;
-            rect.h = surface->h;
-            SDL_RenderCopy(renderer, texture, nullptr, &rect);
-            SDL_DestroyTexture(texture);
-        }
-        SDL_FreeSurface(surface);
+// Integrate the balls of a range, then run the boundary pass over them while
+// they are still in cache.
+template <bool Gravity, bool Drag, bool Friction>
+struct StepBalls {
+    static void run(std::vector<Object*>& objects, size_t begin, size_t end, float dt, const WorldBounds& bounds,
+                    const WorldParams& params) {
+        for (size_t i = begin; i < end; ++i)
+            if (objects[i]->type == ObjectType::BALL)
+                integrateBall<Gravity, Drag>(*static_cast<Ball*>(objects[i]), dt, params);
+        const WallLimits walls(bounds);
+        for (size_t i = begin; i < end; ++i)
+            if (objects[i]->type == ObjectType::BALL)
+                bounceOffWalls<Friction>(*static_cast<Ball*>(objects[i]), walls, dt, params);
     }
-}
+};
 
-SDL_Rect Ball::getBoundingBox() const {
-    SDL_Rect rect;
-    rect.w = static_cast<int>(radius * 2);
-    rect.h = static_cast<int>(radius * 2);
-    rect.x = static_cast<int>(x - radius);
-    rect.y = static_cast<int>(y - radius);
-    return rect;
-}
\ No newline at end of file
+void stepBalls(std::vector<Object*>& objects, size_t begin, size_t end, float dt, const WorldBounds& bounds,
+               const WorldParams& params) {
+    dispatchKernel<StepBalls>(params, objects, begin, end, dt, bounds, params);
+}
@@ -0,0 +1,91 @@
+#include "bitmap_font.hpp"
+#include <cstring>
+
+constexpr uint16_t BLOB_VERSION = 1;
+constexpr size_t HEADER_SIZE = 4 + 5 * 2;
+constexpr size_t GLYPH_RECORD_SIZE = 7 * 2;
+
+constexpr int BitmapFont::FIRST_CHAR;
+constexpr int BitmapFont::LAST_CHAR;
+constexpr int BitmapFont::GLYPH_COUNT;
+
+static void put16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value & 0xff));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static uint16_t get16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+std::vector<uint8_t> BitmapFont::serialize() const {
+    std::vector<uint8_t> out = {'J', 'P', 'S', 'F'};
+    put16(out, BLOB_VERSION);
+    put16(out, static_cast<uint16_t>(width));
+    put16(out, static_cast<uint16_t>(height));
+    put16(out, static_cast<uint16_t>(lineHeight));
+    put16(out, static_cast<uint16_t>(GLYPH_COUNT));
+    for (const Glyph& g : glyphs) {
+        put16(out, g.x);
+        put16(out, g.y);
+        put16(out, g.width);
+        put16(out, g.height);
+        put16(out, static_cast<uint16_t>(g.offsetX));
+        put16(out, static_cast<uint16_t>(g.offsetY));
+        put16(out, static_cast<uint16_t>(g.advance));
+    }
+    // Most of the atlas is empty, so only zero runs are compressed.
+    for (size_t i = 0; i < coverage.size();) {
+        if (coverage[i] != 0) {
+            out.push_back(coverage[i++]);
+            continue;
+        }
+        size_t run = 1;
+        while (run < 255 && i + run < coverage.size() && coverage[i + run] == 0)
+            ++run;
+        out.push_back(0);
+        out.push_back(static_cast<uint8_t>(run));
+        i += run;
+    }
+    return out;
+}
+
+bool BitmapFont::load(const uint8_t* data, size_t size) {
+    if (!data || size < HEADER_SIZE + GLYPH_COUNT * GLYPH_RECORD_SIZE || std::memcmp(data, "JPSF", 4) != 0)
+        return false;
+    if (get16(data + 4) != BLOB_VERSION || get16(data + 12) != GLYPH_COUNT)
+        return false;
+    width = get16(data + 6);
+    height = get16(data + 8);
+    lineHeight = get16(data + 10);
+
+    const uint8_t* p = data + HEADER_SIZE;
+    for (Glyph& g : glyphs) {
+        g.x = get16(p);
+        g.y = get16(p + 2);
+        g.width = get16(p + 4);
+        g.height = get16(p + 6);
+        g.offsetX = static_cast<int16_t>(get16(p + 8));
+        g.offsetY = static_cast<int16_t>(get16(p + 10));
+        g.advance = static_cast<int16_t>(get16(p + 12));
+        if (g.x + g.width > width || g.y + g.height > height)
+            return false;
+        p += GLYPH_RECORD_SIZE;
+    }
+
+    const uint8_t* end = data + size;
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    coverage.clear();
+    coverage.reserve(pixelCount);
+    while (p < end && coverage.size() < pixelCount) {
+        if (*p != 0) {
+            coverage.push_back(*p++);
+            continue;
+        }
+        if (end - p < 2 || p[1] == 0)
+            return false;
+        coverage.insert(coverage.end(), p[1], 0);
+        p += 2;
+    }
+    return coverage.size() == pixelCount && p == end;
+}
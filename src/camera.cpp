@@ -0,0 +1,25 @@
+#include "camera.hpp"
+#include <algorithm>
+
+constexpr float Camera::MIN_ZOOM;
+constexpr float Camera::MAX_ZOOM;
+
+void Camera::pan(float dx, float dy) {
+    x += dx / zoom;
+    y += dy / zoom;
+}
+
+void Camera::zoomAt(float screenX, float screenY, float factor) {
+    const float worldX = toWorldX(screenX);
+    const float worldY = toWorldY(screenY);
+    zoom = std::max(MIN_ZOOM, std::min(zoom * factor, MAX_ZOOM));
+    x = worldX - screenX / zoom;
+    y = worldY - screenY / zoom;
+}
+
+void Camera::fit(const WorldBounds& bounds, int viewWidth, int viewHeight) {
+    zoom = std::min(viewWidth / bounds.width, viewHeight / bounds.height);
+    zoom = std::max(MIN_ZOOM, std::min(zoom, MAX_ZOOM));
+    x = bounds.width * 0.5f - viewWidth * 0.5f / zoom;
+    y = bounds.height * 0.5f - viewHeight * 0.5f / zoom;
+}
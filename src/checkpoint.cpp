@@ -0,0 +1,219 @@
+#include "checkpoint.hpp"
+#include <cstdio>
+#include <algorithm>
+#include <iostream>
+
+constexpr uint32_t CHECKPOINT_MAGIC = 0x5043504A; // "JPCP"
+constexpr uint32_t CHECKPOINT_VERSION = 4;
+
+// File layout: this header, objectCount WorldState::Entry records, then
+// spawnOrderCount uint32 indices. Everything is written as it is in memory,
+// in native byte order, so a checkpoint is only for resuming with the same
+// build. A host of the other byte order reads the magic swapped, and
+// entrySize catches a differently laid out Entry; both are rejected.
+struct CheckpointHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t step;
+    uint64_t frame;
+    double accumulator;
+    double time;
+    float worldWidth, worldHeight;
+    float gravity, airDrag, groundFriction, bounceDamping, frictionCoefficient;
+    uint32_t mode;
+    uint32_t walls;
+    uint32_t entrySize; // sizeof(WorldState::Entry) of the writer
+    uint64_t objectCount;
+    uint64_t spawnOrderCount;
+};
+
+static_assert(sizeof(CheckpointHeader) == 96, "CheckpointHeader must have no padding");
+static_assert(sizeof(WorldState::Entry) == 48, "WorldState::Entry must have no padding");
+
+bool writeCheckpoint(const std::string& path, const Checkpoint& checkpoint) {
+    const WorldState& world = checkpoint.world;
+    CheckpointHeader header;
+    header.magic = CHECKPOINT_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.step = checkpoint.step;
+    header.frame = checkpoint.frame;
+    header.accumulator = checkpoint.accumulator;
+    header.time = world.time;
+    header.worldWidth = world.bounds.width;
+    header.worldHeight = world.bounds.height;
+    header.gravity = world.params.gravity;
+    header.airDrag = world.params.airDrag;
+    header.groundFriction = world.params.groundFriction;
+    header.bounceDamping = world.params.bounceDamping;
+    header.frictionCoefficient = world.params.frictionCoefficient;
+    header.mode = static_cast<uint32_t>(checkpoint.mode);
+    header.walls = world.bounds.walls;
+    header.entrySize = sizeof(WorldState::Entry);
+    header.objectCount = world.objects.size();
+    header.spawnOrderCount = world.spawnOrder.size();
+
+    const std::string temporary = path + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(world.objects.data(), sizeof(WorldState::Entry), world.objects.size(), file) ==
+                   world.objects.size();
+    ok = ok && std::fwrite(world.spawnOrder.data(), sizeof(uint32_t), world.spawnOrder.size(), file) ==
+                   world.spawnOrder.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool readCheckpoint(const std::string& path, Checkpoint& checkpoint, std::string& error) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    CheckpointHeader header;
+    // A checkpoint from a host of the other byte order fails here.
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == CHECKPOINT_MAGIC;
+    if (!ok) {
+        std::fclose(file);
+        error = path + " is not a checkpoint";
+        return false;
+    }
+    if (header.version != CHECKPOINT_VERSION) {
+        std::fclose(file);
+        error = path + " has unsupported checkpoint version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.entrySize != sizeof(WorldState::Entry)) {
+        std::fclose(file);
+        error = path + " was written by a different build";
+        return false;
+    }
+
+    // Check the counts against the file size before allocating anything.
+    std::fseek(file, 0, SEEK_END);
+    const uint64_t size = static_cast<uint64_t>(std::max(0L, std::ftell(file)));
+    std::fseek(file, sizeof(header), SEEK_SET);
+    const uint64_t body = size - std::min<uint64_t>(size, sizeof(header));
+    if (header.objectCount > body / sizeof(WorldState::Entry) ||
+        header.spawnOrderCount > body / sizeof(uint32_t) ||
+        header.objectCount * sizeof(WorldState::Entry) + header.spawnOrderCount * sizeof(uint32_t) != body) {
+        std::fclose(file);
+        error = path + " has the wrong size";
+        return false;
+    }
+
+    WorldState& world = checkpoint.world;
+    world.objects.resize(header.objectCount);
+    world.spawnOrder.resize(header.spawnOrderCount);
+    ok = std::fread(world.objects.data(), sizeof(WorldState::Entry), world.objects.size(), file) ==
+             world.objects.size() &&
+         std::fread(world.spawnOrder.data(), sizeof(uint32_t), world.spawnOrder.size(), file) ==
+             world.spawnOrder.size();
+    std::fclose(file);
+    if (!ok) {
+        error = path + " is truncated";
+        return false;
+    }
+
+    for (const WorldState::Entry& e : world.objects) {
+        if (e.type != ObjectType::BALL && e.type != ObjectType::BOX) {
+            error = path + " is corrupt";
+            return false;
+        }
+    }
+    for (uint32_t index : world.spawnOrder) {
+        if (index >= world.objects.size() || world.objects[index].type != ObjectType::BALL) {
+            error = path + " is corrupt";
+            return false;
+        }
+    }
+    if (header.mode > static_cast<uint32_t>(SolverMode::XPBD) || header.walls > WALLS_ALL) {
+        error = path + " is corrupt";
+        return false;
+    }
+
+    checkpoint.step = header.step;
+    checkpoint.frame = header.frame;
+    checkpoint.accumulator = header.accumulator;
+    checkpoint.mode = static_cast<SolverMode>(header.mode);
+    world.time = header.time;
+    world.bounds.width = header.worldWidth;
+    world.bounds.height = header.worldHeight;
+    world.bounds.walls = static_cast<uint8_t>(header.walls);
+    world.params.gravity = header.gravity;
+    world.params.airDrag = header.airDrag;
+    world.params.groundFriction = header.groundFriction;
+    world.params.bounceDamping = header.bounceDamping;
+    world.params.frictionCoefficient = header.frictionCoefficient;
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path)
+    : path(path)
+{
+    thread = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    thread.join();
+}
+
+std::unique_ptr<Checkpoint> CheckpointWriter::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (spare.empty())
+        return std::unique_ptr<Checkpoint>(new Checkpoint());
+    std::unique_ptr<Checkpoint> checkpoint = std::move(spare.back());
+    spare.pop_back();
+    return checkpoint;
+}
+
+void CheckpointWriter::submit(std::unique_ptr<Checkpoint> checkpoint) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending)
+            spare.push_back(std::move(pending));
+        pending = std::move(checkpoint);
+    }
+    changed.notify_all();
+}
+
+bool CheckpointWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !pending && !writing; });
+    return !failed;
+}
+
+void CheckpointWriter::run() {
+    for (;;) {
+        std::unique_ptr<Checkpoint> checkpoint;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return stopping || pending; });
+            if (!pending)
+                return;
+            checkpoint = std::move(pending);
+            writing = true;
+        }
+        const bool ok = writeCheckpoint(path, *checkpoint);
+        if (!ok)
+            std::cerr << "Writing checkpoint " << path << " failed\n";
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = failed || !ok;
+            writing = false;
+            spare.push_back(std::move(checkpoint));
+        }
+        changed.notify_all();
+    }
+}
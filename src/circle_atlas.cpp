@@ -0,0 +1,164 @@
+#include "circle_atlas.hpp"
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+constexpr int ATLAS_WIDTH = 1024;
+// Empty border around each sprite so linear filtering never picks up a neighbour.
+constexpr int SPRITE_PADDING = 1;
+// Quads per task when generating vertices.
+constexpr size_t QUAD_GRAIN = 1024;
+
+constexpr float CircleAtlas::MAX_SPRITE_RADIUS;
+
+static float clamp01(float value) {
+    return std::max(0.0f, std::min(value, 1.0f));
+}
+
+// White pixel with the given coverage as alpha, in SDL_PIXELFORMAT_RGBA32 byte order.
+static uint32_t coveragePixel(float coverage) {
+    uint8_t rgba[4] = {255, 255, 255, static_cast<uint8_t>(coverage * 255.0f + 0.5f)};
+    uint32_t pixel;
+    std::memcpy(&pixel, rgba, sizeof(pixel));
+    return pixel;
+}
+
+void CircleAtlas::add(float x, float y, float radius, SDL_Color color, CircleStyle style) {
+    Quad q;
+    q.x = x;
+    q.y = y;
+    q.radius = radius;
+    q.color = color;
+    q.sprite = spriteFor(radius, style);
+    quads.push_back(q);
+}
+
+uint32_t CircleAtlas::spriteFor(float radius, CircleStyle style) {
+    const uint32_t halfPixels = static_cast<uint32_t>(std::max(1.0f, std::round(radius * 2.0f)));
+    const uint32_t key = (halfPixels << 1) | (style == CircleStyle::FILLED ? 1u : 0u);
+    auto found = spriteIndex.find(key);
+    if (found != spriteIndex.end())
+        return found->second;
+
+    Sprite sprite;
+    // Huge circles get a smaller sprite that is scaled up when drawn.
+    sprite.radius = std::min(halfPixels * 0.5f, (ATLAS_WIDTH - 2 * SPRITE_PADDING - 2) * 0.5f);
+    sprite.size = static_cast<int>(std::ceil(sprite.radius * 2.0f)) + 2;
+    const int cell = sprite.size + 2 * SPRITE_PADDING;
+
+    // Shelf packing: fill rows left to right, start a new row when one is full.
+    if (shelfX + cell > ATLAS_WIDTH) {
+        shelfY += shelfHeight;
+        shelfX = 0;
+        shelfHeight = 0;
+    }
+    if (shelfY + cell > atlasHeight)
+        grow(shelfY + cell);
+    sprite.x = shelfX + SPRITE_PADDING;
+    sprite.y = shelfY + SPRITE_PADDING;
+    shelfX += cell;
+    shelfHeight = std::max(shelfHeight, cell);
+
+    rasterise(sprite, style);
+    sprites.push_back(sprite);
+    const uint32_t index = static_cast<uint32_t>(sprites.size() - 1);
+    spriteIndex[key] = index;
+    return index;
+}
+
+// Coverage is estimated from the distance of each pixel centre to the circle
+// edge, which gives about one pixel of smooth falloff.
+void CircleAtlas::rasterise(const Sprite& sprite, CircleStyle style) {
+    const float centre = sprite.size * 0.5f;
+    const float radius = sprite.radius;
+    for (int py = 0; py < sprite.size; ++py) {
+        for (int px = 0; px < sprite.size; ++px) {
+            float dx = px + 0.5f - centre;
+            float dy = py + 0.5f - centre;
+            float d = std::sqrt(dx * dx + dy * dy);
+            float coverage = clamp01(radius - d + 0.5f);
+            if (style == CircleStyle::OUTLINE)
+                coverage -= clamp01(radius - 1.0f - d + 0.5f);
+            pixels[static_cast<size_t>(sprite.y + py) * ATLAS_WIDTH + sprite.x + px] = coveragePixel(coverage);
+        }
+    }
+    dirty = true;
+}
+
+void CircleAtlas::grow(int minHeight) {
+    int height = std::max(64, atlasHeight);
+    while (height < minHeight)
+        height *= 2;
+    pixels.resize(static_cast<size_t>(height) * ATLAS_WIDTH, coveragePixel(0.0f));
+    atlasHeight = height;
+    dirty = true;
+}
+
+void CircleAtlas::draw(SDL_Renderer* renderer, ThreadPool* pool) {
+    if (quads.empty())
+        return;
+
+    if (texture && textureHeight != atlasHeight)
+        releaseTexture();
+    if (!texture) {
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                    ATLAS_WIDTH, atlasHeight);
+        if (!texture)
+            return;
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(texture, SDL_ScaleModeLinear);
+        textureHeight = atlasHeight;
+        dirty = true;
+    }
+    if (dirty) {
+        SDL_UpdateTexture(texture, nullptr, pixels.data(), ATLAS_WIDTH * sizeof(uint32_t));
+        dirty = false;
+    }
+
+    const size_t count = quads.size();
+    vertices.resize(count * 4);
+    indices.resize(count * 6);
+    const float invWidth = 1.0f / ATLAS_WIDTH;
+    const float invHeight = 1.0f / atlasHeight;
+
+    auto generate = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Quad& q = quads[i];
+            const Sprite& s = sprites[q.sprite];
+            // Scale the sprite so its circle matches the exact radius.
+            const float half = s.size * 0.5f * (q.radius / s.radius);
+            const float u0 = s.x * invWidth, u1 = (s.x + s.size) * invWidth;
+            const float v0 = s.y * invHeight, v1 = (s.y + s.size) * invHeight;
+            const float xs[4] = {q.x - half, q.x + half, q.x + half, q.x - half};
+            const float ys[4] = {q.y - half, q.y - half, q.y + half, q.y + half};
+            const float us[4] = {u0, u1, u1, u0};
+            const float vs[4] = {v0, v0, v1, v1};
+            SDL_Vertex* v = &vertices[i * 4];
+            for (int k = 0; k < 4; ++k) {
+                v[k].position.x = xs[k];
+                v[k].position.y = ys[k];
+                v[k].color = q.color;
+                v[k].tex_coord.x = us[k];
+                v[k].tex_coord.y = vs[k];
+            }
+            int* idx = &indices[i * 6];
+            const int base = static_cast<int>(i * 4);
+            idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+            idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+        }
+    };
+    if (pool)
+        pool->parallelFor(count, QUAD_GRAIN, generate);
+    else
+        generate(0, count);
+
+    SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                       indices.data(), static_cast<int>(indices.size()));
+}
+
+void CircleAtlas::releaseTexture() {
+    if (texture)
+        SDL_DestroyTexture(texture);
+    texture = nullptr;
+    textureHeight = 0;
+}
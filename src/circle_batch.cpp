@@ -0,0 +1,119 @@
+#include "circle_batch.hpp"
+#include <cmath>
+#include <algorithm>
+
+constexpr float PI = 3.14159265358979f;
+// Largest distance between the true circle and its polygon, in pixels.
+constexpr float MAX_EDGE_ERROR = 0.25f;
+constexpr int MIN_SEGMENTS = 8;
+constexpr int MAX_SEGMENTS = 128;
+// Circles per task when generating vertices.
+constexpr size_t VERTEX_GRAIN = 512;
+
+// Fewest segments that keep the polygon within MAX_EDGE_ERROR of the circle.
+static int segmentsFor(float radius) {
+    if (radius <= MAX_EDGE_ERROR * 2.0f)
+        return MIN_SEGMENTS;
+    float segments = PI / std::acos(1.0f - MAX_EDGE_ERROR / radius);
+    return std::max(MIN_SEGMENTS, std::min(MAX_SEGMENTS, static_cast<int>(std::ceil(segments))));
+}
+
+static void rotate(float &cs, float &sn, float stepCos, float stepSin) {
+    float c = cs * stepCos - sn * stepSin;
+    sn = sn * stepCos + cs * stepSin;
+    cs = c;
+}
+
+static SDL_Vertex makeVertex(float x, float y, SDL_Color color) {
+    SDL_Vertex v;
+    v.position.x = x;
+    v.position.y = y;
+    v.color = color;
+    v.tex_coord.x = 0.0f;
+    v.tex_coord.y = 0.0f;
+    return v;
+}
+
+void CircleBatch::add(float x, float y, float radius, SDL_Color color) {
+    Circle c;
+    c.x = x;
+    c.y = y;
+    c.radius = radius;
+    c.color = color;
+    c.segments = segmentsFor(radius);
+    circles.push_back(c);
+}
+
+// Filled circles are a fan around a centre vertex (segments + 1 vertices,
+// 3 * segments indices). Outlines are a ring of quads between an inner and an
+// outer rim (2 * segments vertices, 6 * segments indices).
+void CircleBatch::build(CircleStyle style, ThreadPool* pool) {
+    const bool filled = style == CircleStyle::FILLED;
+    const size_t count = circles.size();
+
+    // Each circle's range in the vertex and index buffers.
+    firstVertex.resize(count + 1);
+    firstIndex.resize(count + 1);
+    size_t vertexCount = 0, indexCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        firstVertex[i] = vertexCount;
+        firstIndex[i] = indexCount;
+        const size_t n = static_cast<size_t>(circles[i].segments);
+        vertexCount += filled ? n + 1 : 2 * n;
+        indexCount += filled ? 3 * n : 6 * n;
+    }
+    firstVertex[count] = vertexCount;
+    firstIndex[count] = indexCount;
+    vertices.resize(vertexCount);
+    indices.resize(indexCount);
+
+    auto generate = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Circle& c = circles[i];
+            const int n = c.segments;
+            const int v0 = static_cast<int>(firstVertex[i]);
+            int* idx = &indices[firstIndex[i]];
+            // Walk around the circle by rotating a unit vector instead of
+            // calling cos/sin for every vertex.
+            const float stepCos = std::cos(2.0f * PI / n);
+            const float stepSin = std::sin(2.0f * PI / n);
+            float cs = 1.0f, sn = 0.0f;
+
+            if (filled) {
+                vertices[v0] = makeVertex(c.x, c.y, c.color);
+                for (int s = 0; s < n; ++s) {
+                    vertices[v0 + 1 + s] = makeVertex(c.x + cs * c.radius, c.y + sn * c.radius, c.color);
+                    *idx++ = v0;
+                    *idx++ = v0 + 1 + s;
+                    *idx++ = v0 + 1 + (s + 1) % n;
+                    rotate(cs, sn, stepCos, stepSin);
+                }
+            } else {
+                const float outer = c.radius;
+                const float inner = std::max(0.0f, c.radius - 1.0f);
+                for (int s = 0; s < n; ++s) {
+                    vertices[v0 + 2 * s] = makeVertex(c.x + cs * outer, c.y + sn * outer, c.color);
+                    vertices[v0 + 2 * s + 1] = makeVertex(c.x + cs * inner, c.y + sn * inner, c.color);
+                    const int o0 = v0 + 2 * s;
+                    const int o1 = v0 + 2 * ((s + 1) % n);
+                    *idx++ = o0; *idx++ = o1;     *idx++ = o0 + 1;
+                    *idx++ = o0 + 1; *idx++ = o1; *idx++ = o1 + 1;
+                    rotate(cs, sn, stepCos, stepSin);
+                }
+            }
+        }
+    };
+
+    if (pool)
+        pool->parallelFor(count, VERTEX_GRAIN, generate);
+    else
+        generate(0, count);
+}
+
+void CircleBatch::draw(SDL_Renderer* renderer, CircleStyle style, ThreadPool* pool) {
+    if (circles.empty())
+        return;
+    build(style, pool);
+    SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+                       indices.data(), static_cast<int>(indices.size()));
+}
@@ -2,20 +2,19 @@
 #include "object.hpp"
 #include "ball.hpp"
 #include "box.hpp"
+#include "contact_solver.hpp"
 #include <cmath>
 #include <algorithm>
 #include <utility>
 
-constexpr float BOUNCE_DAMPING = 0.7f;
-constexpr float FRICTION_COEFFICIENT = 0.2f; // coefficient for tangential friction
-
 // Helper clamp function.
 static float clamp(float value, float min, float max) {
     return std::max(min, std::min(value, max));
 }
 
 // Resolve collision between two balls using circle collision resolution with friction.
-static void resolveBallBallCollision(Object* a, Object* b) {
+template <bool Friction>
+static void resolveBallBallCollision(Object* a, Object* b, const WorldParams& params) {
     // Cast objects to Ball type.
     Ball* ballA = static_cast<Ball*>(a);
     Ball* ballB = static_cast<Ball*>(b);
@@ -54,7 +53,7 @@ static void resolveBallBallCollision(Object* a, Object* b) {
         return;
 
     // Calculate impulse scalar (assuming unit mass).
-    float impulseScalar = -(1.0f + BOUNCE_DAMPING) * velAlongNormal / 2.0f;
+    float impulseScalar = -(1.0f + params.bounceDamping) * velAlongNormal / 2.0f;
     float impulseX = impulseScalar * nx;
     float impulseY = impulseScalar * ny;
 
@@ -64,6 +63,9 @@ static void resolveBallBallCollision(Object* a, Object* b) {
     ballB->vx += impulseX;
     ballB->vy += impulseY;
 
+    if (!Friction)
+        return;
+
     // Apply friction impulse to simulate tangential resistance.
     float tangentX = rvx - (rvx * nx + rvy * ny) * nx;
     float tangentY = rvy - (rvx * nx + rvy * ny) * ny;
@@ -73,7 +75,7 @@ static void resolveBallBallCollision(Object* a, Object* b) {
         tangentY /= tangentMag;
         float vt = rvx * tangentX + rvy * tangentY;
         // Friction impulse proportional to normal impulse.
-        float frictionImpulse = -FRICTION_COEFFICIENT * impulseScalar;
+        float frictionImpulse = -params.frictionCoefficient * impulseScalar;
         // Limit friction impulse to prevent over-correction.
         if (std::fabs(frictionImpulse) > std::fabs(vt) / 2.0f)
             frictionImpulse = (vt < 0 ? 1 : -1) * std::fabs(vt) / 2.0f;
@@ -86,7 +88,8 @@ static void resolveBallBallCollision(Object* a, Object* b) {
 
 // Resolve collision between a ball and a box using circle-AABB collision detection.
 // This provides more accurate contact resolution such that the ball can rotate or "roll off" the edges.
-static void resolveBallBoxCollision(Ball* ball, Box* box) {
+template <bool Friction>
+static void resolveBallBoxCollision(Ball* ball, Box* box, const WorldParams& params) {
     // Box parameters.
     float boxHalfWidth = box->width * 0.5f;
     float boxHalfHeight = box->height * 0.5f;
@@ -121,7 +124,7 @@ static void resolveBallBoxCollision(Ball* ball, Box* box) {
         return;
 
     // Compute impulse scalar.
-    float impulseScalar = -(1.0f + BOUNCE_DAMPING) * velAlongNormal;
+    float impulseScalar = -(1.0f + params.bounceDamping) * velAlongNormal;
     float impulseX = impulseScalar * nx;
     float impulseY = impulseScalar * ny;
 
@@ -129,6 +132,9 @@ static void resolveBallBoxCollision(Ball* ball, Box* box) {
     ball->vx += impulseX;
     ball->vy += impulseY;
 
+    if (!Friction)
+        return;
+
     // Friction component for tangential impulse.
     float dot = ball->vx * nx + ball->vy * ny;
     float tangentX = ball->vx - dot * nx;
@@ -138,7 +144,7 @@ static void resolveBallBoxCollision(Ball* ball, Box* box) {
         tangentX /= tangentMag;
         tangentY /= tangentMag;
         float vt = ball->vx * tangentX + ball->vy * tangentY;
-        float frictionImpulse = -FRICTION_COEFFICIENT * impulseScalar;
+        float frictionImpulse = -params.frictionCoefficient * impulseScalar;
         if (std::fabs(frictionImpulse) > std::fabs(vt))
             frictionImpulse = (vt < 0 ? 1 : -1) * std::fabs(vt);
         ball->vx += frictionImpulse * tangentX;
@@ -147,7 +153,7 @@ static void resolveBallBoxCollision(Ball* ball, Box* box) {
 }
 
 // For generic AABB collisions (e.g., between two boxes, or non-circle cases).
-static void resolveAABBCollision(Object* a, Object* b) {
+static void resolveAABBCollision(Object* a, Object* b, float damping) {
     float leftA, rightA, topA, bottomA;
     float leftB, rightB, topB, bottomB;
     
@@ -203,20 +209,20 @@ static void resolveAABBCollision(Object* a, Object* b) {
                 b->x -= separation;
             }
             std::swap(a->vx, b->vx);
-            a->vx *= BOUNCE_DAMPING;
-            b->vx *= BOUNCE_DAMPING;
+            a->vx *= damping;
+            b->vx *= damping;
         } else if (!aStatic) {
             if (a->x < b->x)
                 a->x -= overlapX;
             else
                 a->x += overlapX;
-            a->vx = -a->vx * BOUNCE_DAMPING;
+            a->vx = -a->vx * damping;
         } else if (!bStatic) {
             if (b->x < a->x)
                 b->x -= overlapX;
             else
                 b->x += overlapX;
-            b->vx = -b->vx * BOUNCE_DAMPING;
+            b->vx = -b->vx * damping;
         }
     } else {
         if (!aStatic && !bStatic) {
@@ -229,38 +235,50 @@ static void resolveAABBCollision(Object* a, Object* b) {
                 b->y -= separation;
             }
             std::swap(a->vy, b->vy);
-            a->vy *= BOUNCE_DAMPING;
-            b->vy *= BOUNCE_DAMPING;
+            a->vy *= damping;
+            b->vy *= damping;
         } else if (!aStatic) {
             if (a->y < b->y)
                 a->y -= overlapY;
             else
                 a->y += overlapY;
-            a->vy = -a->vy * BOUNCE_DAMPING;
+            a->vy = -a->vy * damping;
         } else if (!bStatic) {
             if (b->y < a->y)
                 b->y -= overlapY;
             else
                 b->y += overlapY;
-            b->vy = -b->vy * BOUNCE_DAMPING;
+            b->vy = -b->vy * damping;
         }
     }
 }
 
-void resolveCollision(Object* a, Object* b) {
+template <bool Friction>
+static void resolve(Object* a, Object* b, const WorldParams& params) {
     // If both objects are balls, use circle collision resolution.
     if (a->type == ObjectType::BALL && b->type == ObjectType::BALL) {
-        resolveBallBallCollision(a, b);
+        resolveBallBallCollision<Friction>(a, b, params);
     } 
     // If one is a ball and the other a box, use the more accurate circle-AABB collision.
     else if (a->type == ObjectType::BALL && b->type == ObjectType::BOX) {
-        resolveBallBoxCollision(static_cast<Ball*>(a), static_cast<Box*>(b));
+        resolveBallBoxCollision<Friction>(static_cast<Ball*>(a), static_cast<Box*>(b), params);
     } 
     else if (a->type == ObjectType::BOX && b->type == ObjectType::BALL) {
-        resolveBallBoxCollision(static_cast<Ball*>(b), static_cast<Box*>(a));
+        resolveBallBoxCollision<Friction>(static_cast<Ball*>(b), static_cast<Box*>(a), params);
     }
     // Otherwise, use generic AABB resolution.
     else {
-        resolveAABBCollision(a, b);
+        resolveAABBCollision(a, b, params.bounceDamping);
+    }
+}
+
+void resolveCollisions(std::vector<Object*>& objects, const Contact* contacts, size_t count,
+                       const WorldParams& params) {
+    if (params.frictionCoefficient != 0.0f) {
+        for (size_t i = 0; i < count; ++i)
+            resolve<true>(objects[contacts[i].a], objects[contacts[i].b], params);
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            resolve<false>(objects[contacts[i].a], objects[contacts[i].b], params);
     }
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "command_buffer.hpp"
+#include <cstring>
+
+void CommandBuffer::clear() {
+    list.clear();
+    strings.clear();
+    currentLayer = DrawLayer::WORLD;
+}
+
+DrawCommand& CommandBuffer::push(DrawOp op, SDL_Color color) {
+    DrawCommand c;
+    c.op = op;
+    c.layer = currentLayer;
+    c.style = CircleStyle::OUTLINE;
+    c.blend = SDL_BLENDMODE_NONE;
+    c.color = color;
+    c.x = c.y = c.a = c.b = 0.0f;
+    c.text = 0;
+    list.push_back(c);
+    return list.back();
+}
+
+void CommandBuffer::point(float x, float y, SDL_Color color) {
+    DrawCommand& c = push(DrawOp::POINT, color);
+    c.x = x;
+    c.y = y;
+}
+
+void CommandBuffer::line(float x0, float y0, float x1, float y1, SDL_Color color) {
+    DrawCommand& c = push(DrawOp::LINE, color);
+    c.x = x0;
+    c.y = y0;
+    c.a = x1;
+    c.b = y1;
+}
+
+void CommandBuffer::aaLine(float x0, float y0, float x1, float y1, SDL_Color color) {
+    DrawCommand& c = push(DrawOp::AA_LINE, color);
+    c.x = x0;
+    c.y = y0;
+    c.a = x1;
+    c.b = y1;
+}
+
+void CommandBuffer::rect(const SDL_Rect& rect, SDL_Color color) {
+    DrawCommand& c = push(DrawOp::RECT, color);
+    c.x = static_cast<float>(rect.x);
+    c.y = static_cast<float>(rect.y);
+    c.a = static_cast<float>(rect.w);
+    c.b = static_cast<float>(rect.h);
+}
+
+void CommandBuffer::fillRect(const SDL_Rect& rect, SDL_Color color, SDL_BlendMode blend) {
+    DrawCommand& c = push(DrawOp::FILL_RECT, color);
+    c.blend = blend;
+    c.x = static_cast<float>(rect.x);
+    c.y = static_cast<float>(rect.y);
+    c.a = static_cast<float>(rect.w);
+    c.b = static_cast<float>(rect.h);
+}
+
+void CommandBuffer::circle(float x, float y, float radius, SDL_Color color, CircleStyle style) {
+    DrawCommand& c = push(DrawOp::CIRCLE, color);
+    c.style = style;
+    c.x = x;
+    c.y = y;
+    c.a = radius;
+}
+
+void CommandBuffer::text(const char* str, float x, float y, SDL_Color color) {
+    DrawCommand& c = push(DrawOp::TEXT, color);
+    c.x = x;
+    c.y = y;
+    c.text = static_cast<uint32_t>(strings.size());
+    strings.insert(strings.end(), str, str + std::strlen(str) + 1);
+}
+
+void CommandBuffer::shadowedText(const char* str, float x, float y, SDL_Color color, SDL_Color shadow) {
+    text(str, x + 1.0f, y + 1.0f, shadow);
+    text(str, x, y, color);
+}
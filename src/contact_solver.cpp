@@ -0,0 +1,166 @@
+#include "contact_solver.hpp"
+#include "collision.hpp"
+#include "ball.hpp"
+#include "box.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Number of sweep positions handled by one detection task. Fixed so the
+// partitioning never depends on the thread count.
+constexpr size_t SWEEP_BLOCK = 256;
+// Contacts per task when resolving a colour.
+constexpr size_t SOLVE_GRAIN = 64;
+// Colours tracked per object; contacts that do not fit go into a serial batch.
+constexpr unsigned MAX_COLOURS = 64;
+
+void ContactSolver::solve(std::vector<Object*>& objects, const WorldParams& params, ThreadPool& pool) {
+    prepare(objects, pool);
+    resolve(objects, params, pool);
+}
+
+void ContactSolver::resolve(std::vector<Object*>& objects, const WorldParams& params, ThreadPool& pool) {
+    for (size_t k = 0; k < batchCount(); ++k) {
+        size_t begin, end;
+        batch(k, begin, end);
+        if (isSerialBatch(k)) {
+            resolveCollisions(objects, coloured.data() + begin, end - begin, params);
+            continue;
+        }
+        pool.parallelFor(end - begin, SOLVE_GRAIN, [&](size_t first, size_t last) {
+            resolveCollisions(objects, coloured.data() + begin + first, last - first, params);
+        });
+    }
+}
+
+void ContactSolver::prepare(const std::vector<Object*>& objects, ThreadPool& pool) {
+    findContacts(objects, pool);
+    colourContacts(objects.size());
+}
+
+// Sweep and prune along x. Every block of the sorted order collects its own
+// pairs, and the merged list is sorted by (a, b) afterwards so contacts come
+// out in the order the old i < j double loop visited them.
+void ContactSolver::findContacts(const std::vector<Object*>& objects, ThreadPool& pool) {
+    const size_t n = objects.size();
+    bounds.resize(n);
+    sweepOrder.resize(n);
+    pool.parallelFor(n, 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Object* obj = objects[i];
+            Bounds& b = bounds[i];
+            if (obj->type == ObjectType::BALL) {
+                const Ball* ball = static_cast<const Ball*>(obj);
+                const float extentX = ball->radius + margin + std::fabs(ball->vx) * sweepTime;
+                const float extentY = ball->radius + margin + std::fabs(ball->vy) * sweepTime;
+                b.minX = ball->x - extentX;
+                b.maxX = ball->x + extentX;
+                b.minY = ball->y - extentY;
+                b.maxY = ball->y + extentY;
+                b.isStatic = false;
+            } else {
+                const Box* box = static_cast<const Box*>(obj);
+                b.minX = box->x - box->width * 0.5f;
+                b.maxX = box->x + box->width * 0.5f;
+                b.minY = box->y - box->height * 0.5f;
+                b.maxY = box->y + box->height * 0.5f;
+                b.isStatic = true;
+            }
+            sweepOrder[i] = static_cast<uint32_t>(i);
+        }
+    });
+
+    std::sort(sweepOrder.begin(), sweepOrder.end(), [this](uint32_t l, uint32_t r) {
+        if (bounds[l].minX != bounds[r].minX)
+            return bounds[l].minX < bounds[r].minX;
+        return l < r;
+    });
+
+    const size_t blocks = (n + SWEEP_BLOCK - 1) / SWEEP_BLOCK;
+    blockContacts.resize(blocks);
+    pool.parallelFor(blocks, 1, [&](size_t firstBlock, size_t lastBlock) {
+        for (size_t blk = firstBlock; blk < lastBlock; ++blk) {
+            std::vector<Contact>& out = blockContacts[blk];
+            out.clear();
+            const size_t end = std::min(n, (blk + 1) * SWEEP_BLOCK);
+            for (size_t s = blk * SWEEP_BLOCK; s < end; ++s) {
+                const uint32_t i = sweepOrder[s];
+                const Bounds& bi = bounds[i];
+                for (size_t t = s + 1; t < n; ++t) {
+                    const uint32_t j = sweepOrder[t];
+                    const Bounds& bj = bounds[j];
+                    if (bj.minX > bi.maxX)
+                        break;
+                    // Two static objects never move each other.
+                    if (bi.isStatic && bj.isStatic)
+                        continue;
+                    if (bj.minY > bi.maxY || bi.minY > bj.maxY)
+                        continue;
+                    Contact c;
+                    c.a = std::min(i, j);
+                    c.b = std::max(i, j);
+                    out.push_back(c);
+                }
+            }
+        }
+    });
+
+    found.clear();
+    for (const auto& block : blockContacts)
+        found.insert(found.end(), block.begin(), block.end());
+    std::sort(found.begin(), found.end(), [](const Contact& l, const Contact& r) {
+        return l.a != r.a ? l.a < r.a : l.b < r.b;
+    });
+}
+
+// Greedy colouring in contact order: each contact takes the lowest colour not
+// yet used by either of its dynamic objects. Static objects are never written
+// by a resolve, so they may appear in any number of contacts of one colour.
+void ContactSolver::colourContacts(size_t objectCount) {
+    usedColours.assign(objectCount, 0);
+    contactColour.resize(found.size());
+
+    size_t counts[MAX_COLOURS + 1] = {};
+    for (size_t k = 0; k < found.size(); ++k) {
+        const Contact& c = found[k];
+        uint64_t used = 0;
+        if (!bounds[c.a].isStatic)
+            used |= usedColours[c.a];
+        if (!bounds[c.b].isStatic)
+            used |= usedColours[c.b];
+
+        unsigned colour = MAX_COLOURS;
+        if (~used != 0) {
+            colour = static_cast<unsigned>(__builtin_ctzll(~used));
+            const uint64_t bit = uint64_t(1) << colour;
+            usedColours[c.a] |= bit;
+            usedColours[c.b] |= bit;
+        }
+        contactColour[k] = static_cast<uint8_t>(colour);
+        counts[colour]++;
+    }
+
+    // Stable counting sort by colour keeps the detection order inside a colour.
+    hasOverflow = counts[MAX_COLOURS] != 0;
+    unsigned colourCount = 0;
+    for (unsigned c = 0; c < MAX_COLOURS; ++c)
+        if (counts[c] != 0)
+            colourCount = c + 1;
+
+    batchStart.assign(1, 0);
+    size_t offsets[MAX_COLOURS + 1];
+    size_t total = 0;
+    for (unsigned c = 0; c < colourCount; ++c) {
+        offsets[c] = total;
+        total += counts[c];
+        batchStart.push_back(total);
+    }
+    if (hasOverflow) {
+        offsets[MAX_COLOURS] = total;
+        total += counts[MAX_COLOURS];
+        batchStart.push_back(total);
+    }
+
+    coloured.resize(found.size());
+    for (size_t k = 0; k < found.size(); ++k)
+        coloured[offsets[contactColour[k]]++] = found[k];
+}
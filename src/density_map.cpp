@@ -0,0 +1,136 @@
+#include "density_map.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Rows per band.
+constexpr int BAND_ROWS = 16;
+// Balls binned by one task.
+constexpr size_t BIN_CHUNK = 65536;
+// Counts at or above this get the brightest colour.
+constexpr size_t PALETTE_SIZE = 256;
+
+static float clamp01(float value) {
+    return std::max(0.0f, std::min(value, 1.0f));
+}
+
+// Black through blue and red to white for t in [0, 1].
+static uint32_t heatColor(float t) {
+    const float r = clamp01(t * 3.0f - 1.0f);
+    const float g = clamp01(t * 3.0f - 2.0f);
+    const float b = t < 2.0f / 3.0f ? clamp01(std::min(t * 3.0f, 2.0f - t * 3.0f)) : clamp01(t * 3.0f - 2.0f);
+    return 0xFF000000 | (static_cast<uint32_t>(r * 255.0f + 0.5f) << 16) |
+           (static_cast<uint32_t>(g * 255.0f + 0.5f) << 8) | static_cast<uint32_t>(b * 255.0f + 0.5f);
+}
+
+DensityMap::DensityMap() {
+    // Logarithmic, so single balls stay visible next to dense piles.
+    palette.resize(PALETTE_SIZE);
+    palette[0] = 0xFF000000;
+    const float scale = 1.0f / std::log2(static_cast<float>(PALETTE_SIZE));
+    for (size_t c = 1; c < PALETTE_SIZE; ++c)
+        palette[c] = heatColor(0.15f + 0.85f * std::log2(static_cast<float>(c + 1)) * scale);
+}
+
+DensityMap::~DensityMap() {
+    releaseTexture();
+}
+
+void DensityMap::releaseTexture() {
+    if (texture)
+        SDL_DestroyTexture(texture);
+    texture = nullptr;
+    textureWidth = textureHeight = 0;
+}
+
+bool DensityMap::ensureTexture(SDL_Renderer* renderer, int width, int height) {
+    if (texture && width == textureWidth && height == textureHeight)
+        return true;
+    releaseTexture();
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!texture)
+        return false;
+    // Empty pixels are black, so adding leaves whatever is below them.
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_ADD);
+    textureWidth = width;
+    textureHeight = height;
+    return true;
+}
+
+bool DensityMap::draw(SDL_Renderer* renderer, int width, int height, const std::vector<ObjectState>& objects,
+                      const std::vector<size_t>& balls, uint32_t weight, const Camera& camera,
+                      ThreadPool* pool) {
+    if (width <= 0 || height <= 0 || !ensureTexture(renderer, width, height))
+        return false;
+    bandCount = static_cast<size_t>((height + BAND_ROWS - 1) / BAND_ROWS);
+    counts.resize(static_cast<size_t>(width) * height);
+
+    const size_t chunks = (balls.size() + BIN_CHUNK - 1) / BIN_CHUNK;
+    chunkBins.resize(chunks);
+    auto binChunks = [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c)
+            bin(c, objects, balls, camera);
+    };
+    if (pool)
+        pool->parallelFor(chunks, 1, binChunks);
+    else
+        binChunks(0, chunks);
+
+    void* locked;
+    int pitch;
+    if (SDL_LockTexture(texture, nullptr, &locked, &pitch) != 0)
+        return false;
+    uint8_t* pixels = static_cast<uint8_t*>(locked);
+    auto fillBands = [&](size_t begin, size_t end) {
+        for (size_t band = begin; band < end; ++band)
+            fillBand(band, weight, pixels, pitch);
+    };
+    if (pool)
+        pool->parallelFor(bandCount, 1, fillBands);
+    else
+        fillBands(0, bandCount);
+    SDL_UnlockTexture(texture);
+
+    return SDL_RenderCopy(renderer, texture, nullptr, nullptr) == 0;
+}
+
+void DensityMap::bin(size_t chunk, const std::vector<ObjectState>& objects,
+                     const std::vector<size_t>& balls, const Camera& camera) {
+    std::vector<std::vector<uint32_t>>& bins = chunkBins[chunk];
+    bins.resize(bandCount);
+    for (auto& band : bins)
+        band.clear();
+
+    const size_t begin = chunk * BIN_CHUNK;
+    const size_t end = std::min(balls.size(), (chunk + 1) * BIN_CHUNK);
+    for (size_t i = begin; i < end; ++i) {
+        const ObjectState& obj = objects[balls[i]];
+        const float sx = camera.toScreenX(obj.x);
+        const float sy = camera.toScreenY(obj.y);
+        // Negative values would truncate towards the first row or column.
+        if (sx < 0.0f || sy < 0.0f)
+            continue;
+        const int x = static_cast<int>(sx);
+        const int y = static_cast<int>(sy);
+        if (x >= textureWidth || y >= textureHeight)
+            continue;
+        bins[static_cast<size_t>(y / BAND_ROWS)].push_back(static_cast<uint32_t>(y * textureWidth + x));
+    }
+}
+
+void DensityMap::fillBand(size_t band, uint32_t weight, uint8_t* pixels, int pitch) {
+    const int firstRow = static_cast<int>(band) * BAND_ROWS;
+    const int lastRow = std::min(firstRow + BAND_ROWS, textureHeight);
+    uint32_t* bandCounts = counts.data() + static_cast<size_t>(firstRow) * textureWidth;
+    std::fill(bandCounts, bandCounts + static_cast<size_t>(lastRow - firstRow) * textureWidth, 0u);
+
+    for (const auto& bins : chunkBins)
+        for (uint32_t pixel : bins[band])
+            counts[pixel] += weight;
+
+    for (int y = firstRow; y < lastRow; ++y) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(pixels + static_cast<size_t>(y) * pitch);
+        const uint32_t* rowCounts = counts.data() + static_cast<size_t>(y) * textureWidth;
+        for (int x = 0; x < textureWidth; ++x)
+            row[x] = palette[std::min<uint32_t>(rowCounts[x], PALETTE_SIZE - 1)];
+    }
+}
@@ -0,0 +1,118 @@
+#include "frame_encoder.hpp"
+#include <algorithm>
+
+FrameEncoder::FrameEncoder(FILE* out, VideoFormat format, int width, int height, int fps, size_t bufferCount)
+    : out(out), format(format), width(width), height(height), fps(fps),
+      buffers(std::max<size_t>(1, bufferCount))
+{
+    for (auto& buffer : buffers) {
+        buffer.resize(static_cast<size_t>(width) * height * 4);
+        freeBuffers.push_back(&buffer);
+    }
+    thread = std::thread(&FrameEncoder::run, this);
+}
+
+FrameEncoder::~FrameEncoder() {
+    finish();
+}
+
+std::vector<uint8_t>* FrameEncoder::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !freeBuffers.empty(); });
+    std::vector<uint8_t>* frame = freeBuffers.back();
+    freeBuffers.pop_back();
+    return frame;
+}
+
+void FrameEncoder::submit(std::vector<uint8_t>* frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back(frame);
+    }
+    changed.notify_all();
+}
+
+bool FrameEncoder::finish() {
+    if (!thread.joinable())
+        return !failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    thread.join();
+    if (std::fflush(out) != 0)
+        failed = true;
+    return !failed;
+}
+
+void FrameEncoder::run() {
+    for (;;) {
+        std::vector<uint8_t>* frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return stopping || !queued.empty(); });
+            if (queued.empty())
+                return;
+            frame = queued.front();
+            queued.pop_front();
+        }
+        // After a failed write the frames are still recycled so the producer never blocks.
+        if (!failed && !write(*frame))
+            failed = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeBuffers.push_back(frame);
+        }
+        changed.notify_all();
+    }
+}
+
+bool FrameEncoder::write(const std::vector<uint8_t>& frame) {
+    if (format == VideoFormat::RGBA)
+        return std::fwrite(frame.data(), 1, frame.size(), out) == frame.size();
+
+    if (!headerWritten) {
+        if (std::fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, fps) < 0)
+            return false;
+        headerWritten = true;
+    }
+
+    // Full range BT.601 in 16.16 fixed point. Chroma is averaged over 2x2 blocks.
+    const int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    const size_t lumaSize = static_cast<size_t>(width) * height;
+    const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    planes.resize(lumaSize + 2 * chromaSize);
+    uint8_t* yPlane = planes.data();
+    uint8_t* uPlane = yPlane + lumaSize;
+    uint8_t* vPlane = uPlane + chromaSize;
+
+    for (size_t i = 0; i < lumaSize; ++i) {
+        const uint8_t* p = &frame[i * 4];
+        yPlane[i] = static_cast<uint8_t>((19595 * p[0] + 38470 * p[1] + 7471 * p[2] + 32768) >> 16);
+    }
+    for (int cy = 0; cy < chromaHeight; ++cy) {
+        for (int cx = 0; cx < chromaWidth; ++cx) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int y = cy * 2; y < std::min(cy * 2 + 2, height); ++y) {
+                for (int x = cx * 2; x < std::min(cx * 2 + 2, width); ++x) {
+                    const uint8_t* p = &frame[(static_cast<size_t>(y) * width + x) * 4];
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    ++n;
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            const int u = (-11059 * r - 21709 * g + 32768 * b + (128 << 16) + 32768) >> 16;
+            const int v = (32768 * r - 27439 * g - 5329 * b + (128 << 16) + 32768) >> 16;
+            uPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::max(0, std::min(u, 255)));
+            vPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::max(0, std::min(v, 255)));
+        }
+    }
+
+    return std::fputs("FRAME\n", out) >= 0 &&
+           std::fwrite(planes.data(), 1, planes.size(), out) == planes.size();
+}
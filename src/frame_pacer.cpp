@@ -0,0 +1,89 @@
+#include "frame_pacer.hpp"
+#include <algorithm>
+#include <thread>
+
+// Used when the display does not report its refresh rate.
+constexpr double DEFAULT_REFRESH_RATE = 60.0;
+// The last part of a wait is spun instead of slept, in milliseconds.
+constexpr double SPIN_TIME = 2.0;
+
+constexpr size_t FramePacer::HISTORY;
+
+FramePacer::FramePacer(PacingMode mode, double targetFps)
+    : pacingMode(mode), requestedFps(targetFps), frequency(SDL_GetPerformanceFrequency())
+{
+    frameTimes.reserve(HISTORY);
+    sorted.reserve(HISTORY);
+    setRefreshRate(0);
+}
+
+Uint32 FramePacer::rendererFlags() const {
+    Uint32 flags = SDL_RENDERER_ACCELERATED;
+    if (pacingMode == PacingMode::VSYNC)
+        flags |= SDL_RENDERER_PRESENTVSYNC;
+    return flags;
+}
+
+void FramePacer::setRefreshRate(int hz) {
+    const double fps = requestedFps > 0.0 ? requestedFps : hz > 0 ? hz : DEFAULT_REFRESH_RATE;
+    period = static_cast<Uint64>(frequency / fps);
+}
+
+void FramePacer::endFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (pacingMode == PacingMode::TARGET && lastFrame != 0) {
+        deadline += period;
+        // Too far behind to catch up; start a new schedule from now.
+        if (now > deadline + period)
+            deadline = now;
+        const Uint64 spinTicks = static_cast<Uint64>(frequency * SPIN_TIME / 1000.0);
+        while (now + spinTicks < deadline) {
+            SDL_Delay(static_cast<Uint32>((deadline - now - spinTicks) * 1000 / frequency) + 1);
+            now = SDL_GetPerformanceCounter();
+        }
+        while (now < deadline) {
+            std::this_thread::yield();
+            now = SDL_GetPerformanceCounter();
+        }
+    }
+
+    if (lastFrame == 0) {
+        deadline = now;
+        statsStart = now;
+    } else {
+        const float ms = static_cast<float>((now - lastFrame) * 1000.0 / frequency);
+        lastFrameTime = ms;
+        if (frameTimes.size() < HISTORY)
+            frameTimes.push_back(ms);
+        else
+            frameTimes[nextSample] = ms;
+        nextSample = (nextSample + 1) % HISTORY;
+        framesSinceStats++;
+    }
+    lastFrame = now;
+}
+
+FrameStats FramePacer::takeStats() {
+    FrameStats stats;
+    const size_t count = std::min(framesSinceStats, frameTimes.size());
+    if (count == 0)
+        return stats;
+
+    // The newest count samples end just before nextSample.
+    sorted.clear();
+    for (size_t i = 0; i < count; ++i)
+        sorted.push_back(frameTimes[(nextSample + HISTORY - count + i) % HISTORY]);
+    const size_t p50 = count / 2;
+    const size_t p99 = std::min(count - 1, count * 99 / 100);
+    std::nth_element(sorted.begin(), sorted.begin() + p50, sorted.end());
+    stats.p50 = sorted[p50];
+    std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+    stats.p99 = sorted[p99];
+    stats.max = *std::max_element(sorted.begin(), sorted.end());
+
+    const double elapsed = static_cast<double>(lastFrame - statsStart) / frequency;
+    stats.fps = elapsed > 0.0 ? static_cast<float>(framesSinceStats / elapsed) : 0.0f;
+    statsStart = lastFrame;
+    framesSinceStats = 0;
+    return stats;
+}
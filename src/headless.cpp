@@ -0,0 +1,154 @@
+#include "headless.hpp"
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+
+// Copy the state at the start of a frame and hand it to the writer.
+static void takeCheckpoint(CheckpointWriter& writer, World& world, const PhysicsStepper& stepper, SolverMode mode,
+                           long frame, double accumulator) {
+    std::unique_ptr<Checkpoint> checkpoint = writer.acquire();
+    {
+        TimedLock lock(world.mutex, world.locks, LockSite::SNAPSHOT);
+        world.saveState(checkpoint->world);
+    }
+    checkpoint->step = stepper.stepCount();
+    checkpoint->frame = static_cast<uint64_t>(frame);
+    checkpoint->accumulator = accumulator;
+    checkpoint->mode = mode;
+    writer.submit(std::move(checkpoint));
+}
+
+// Hand the times of the last step to the metrics.
+static void recordStep(Metrics& metrics, const PhysicsStepper& stepper) {
+    metrics.stepDuration.observe(stepper.lastTimes().total());
+    metrics.contacts.store(static_cast<uint32_t>(stepper.contactCount()), std::memory_order_relaxed);
+}
+
+int runHeadless(World& world, const PhysicsSettings& physics, const ViewState& view, const HeadlessSettings& settings,
+                const Checkpoint* resume) {
+    FILE* out = settings.output == "-" ? stdout : std::fopen(settings.output.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Cannot open " << settings.output << " for writing\n";
+        return 1;
+    }
+
+    // Draw into memory with the software renderer; no video driver is needed.
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, settings.width, settings.height, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer* renderer = target ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    SceneRenderer scene(world.bounds);
+    if (!renderer || !scene.init(renderer)) {
+        std::cerr << "Offscreen renderer Error: " << SDL_GetError() << "\n";
+        if (renderer)
+            SDL_DestroyRenderer(renderer);
+        if (target)
+            SDL_FreeSurface(target);
+        if (out != stdout)
+            std::fclose(out);
+        return 1;
+    }
+
+    PhysicsStepper stepper(physics.threads);
+    const SolverMode mode = physics.solverMode.load();
+    const float stepSize = PhysicsStepper::stepSize(mode);
+    const double frameTime = 1.0 / settings.fps;
+    const long frameCount = std::lround(settings.duration * settings.fps);
+
+    long firstFrame = 0;
+    double accumulator = 0.0;
+    if (resume) {
+        firstFrame = static_cast<long>(resume->frame);
+        accumulator = resume->accumulator;
+        stepper.setStepCount(resume->step);
+    }
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    if (!settings.checkpoint.empty())
+        checkpoints.reset(new CheckpointWriter(settings.checkpoint));
+    const long checkpointFrames = std::max(1L, std::lround(settings.checkpointInterval * settings.fps));
+
+    Metrics* const metrics = physics.metrics;
+    WorldSnapshot snapshot;
+    FrameEncoder encoder(out, settings.format, settings.width, settings.height, settings.fps);
+    for (long frame = firstFrame; frame < frameCount; ++frame) {
+        const double frameStart = phaseClock();
+        if (checkpoints && frame != firstFrame && frame % checkpointFrames == 0)
+            takeCheckpoint(*checkpoints, world, stepper, mode, frame, accumulator);
+        {
+            TimedLock lock(world.mutex, world.locks, LockSite::SNAPSHOT);
+            snapshot.capture(world.objects);
+        }
+        if (metrics)
+            metrics->recordObjects(snapshot);
+        char hudText[64];
+        std::snprintf(hudText, sizeof(hudText), "t = %.2f s%s", frame * frameTime,
+                      mode == SolverMode::XPBD ? " (XPBD)" : "");
+        scene.draw(renderer, &snapshot, view, hudText, nullptr);
+
+        std::vector<uint8_t>* pixels = encoder.acquire();
+        SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32, pixels->data(), settings.width * 4);
+        encoder.submit(pixels);
+
+        // Whole steps only; the remainder carries over to the next frame.
+        accumulator += frameTime;
+        while (accumulator >= stepSize) {
+            TimedLock lock(world.mutex, world.locks, LockSite::STEP);
+            stepper.step(world.objects, mode, world.bounds, world.params);
+            world.updateLifetimes(stepSize);
+            accumulator -= stepSize;
+            if (metrics)
+                recordStep(*metrics, stepper);
+        }
+        if (metrics)
+            metrics->frameDuration.observe(phaseClock() - frameStart);
+    }
+    const bool written = encoder.finish();
+    // The writer reports its own errors.
+    bool checkpointed = true;
+    if (checkpoints) {
+        takeCheckpoint(*checkpoints, world, stepper, mode, std::max(firstFrame, frameCount), accumulator);
+        checkpointed = checkpoints->flush();
+    }
+
+    scene.releaseTextures();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    if (out != stdout && std::fclose(out) != 0)
+        return 1;
+    if (!written) {
+        std::cerr << "Writing " << settings.output << " failed\n";
+        return 1;
+    }
+    if (!checkpointed)
+        return 1;
+    std::cerr << "Recorded " << std::max(0L, frameCount - firstFrame) << " frames (" << stepper.stepCount()
+              << " physics steps)\n";
+    return 0;
+}
+
+int runBenchmark(World& world, const PhysicsSettings& physics, long steps) {
+    PhysicsStepper stepper(physics.threads);
+    const SolverMode mode = physics.solverMode.load();
+    const float stepSize = PhysicsStepper::stepSize(mode);
+    const size_t objects = world.objects.size();
+    if (physics.metrics) {
+        WorldSnapshot snapshot;
+        snapshot.capture(world.objects);
+        physics.metrics->recordObjects(snapshot);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < steps; ++i) {
+        TimedLock lock(world.mutex, world.locks, LockSite::STEP);
+        stepper.step(world.objects, mode, world.bounds, world.params);
+        world.updateLifetimes(stepSize);
+        if (physics.metrics)
+            recordStep(*physics.metrics, stepper);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%zu objects, %ld steps in %.3f s: %.1f steps/s, %.3f ms/step, hash %016llx\n", objects, steps,
+                seconds, steps / seconds, seconds * 1000.0 / steps,
+                static_cast<unsigned long long>(hashObjects(world.objects)));
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "lock_stats.hpp"
+#include <algorithm>
+#include <cstdio>
+
+const char* lockSiteName(LockSite site) {
+    switch (site) {
+        case LockSite::STEP: return "step";
+        case LockSite::SNAPSHOT: return "snapshot";
+        case LockSite::SPAWN: return "spawn";
+        case LockSite::EDIT: return "edit";
+    }
+    return "?";
+}
+
+constexpr size_t LockStats::BUCKETS;
+
+LockStats::LockStats() : epoch(std::chrono::steady_clock::now()) {
+    for (Site& site : sites) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            site.wait[i].store(0, std::memory_order_relaxed);
+            site.hold[i].store(0, std::memory_order_relaxed);
+        }
+        site.waitNanos.store(0, std::memory_order_relaxed);
+        site.holdNanos.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LockStats::bucketLimit(size_t bucket) {
+    return bucket + 1 < BUCKETS ? 1000ull << (2 * bucket) : 0;
+}
+
+size_t LockStats::bucket(uint64_t nanos) {
+    size_t i = 0;
+    while (i + 1 < BUCKETS && nanos >= bucketLimit(i))
+        ++i;
+    return i;
+}
+
+uint64_t LockStats::now() const {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void LockStats::record(LockSite site, uint64_t start, uint64_t wait, uint64_t hold) {
+    Site& s = sites[static_cast<size_t>(site)];
+    s.wait[bucket(wait)].fetch_add(1, std::memory_order_relaxed);
+    s.hold[bucket(hold)].fetch_add(1, std::memory_order_relaxed);
+    s.waitNanos.fetch_add(wait, std::memory_order_relaxed);
+    s.holdNanos.fetch_add(hold, std::memory_order_relaxed);
+    if (traceCapacity == 0)
+        return;
+    // Once the trace is full further locks are only counted.
+    const size_t index = traceNext.fetch_add(1, std::memory_order_relaxed);
+    if (index < traceCapacity)
+        trace[index] = {start, wait, hold, site};
+}
+
+void LockStats::read(LockSite site, Counts& counts) const {
+    const Site& s = sites[static_cast<size_t>(site)];
+    counts.locks = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts.wait[i] = s.wait[i].load(std::memory_order_relaxed);
+        counts.hold[i] = s.hold[i].load(std::memory_order_relaxed);
+        counts.locks += counts.hold[i];
+    }
+    counts.waitNanos = s.waitNanos.load(std::memory_order_relaxed);
+    counts.holdNanos = s.holdNanos.load(std::memory_order_relaxed);
+}
+
+void LockStats::startTrace(size_t capacity) {
+    trace.reset(new TraceEvent[capacity]);
+    traceCapacity = capacity;
+    traceNext.store(0, std::memory_order_relaxed);
+}
+
+bool LockStats::writeTrace(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const size_t taken = traceNext.load(std::memory_order_relaxed);
+    const size_t count = std::min(taken, traceCapacity);
+    std::fprintf(file, "{\"otherData\": {\"droppedLocks\": %zu},\n\"traceEvents\": [\n"
+                 "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"world lock\"}}",
+                 taken - count);
+    for (size_t i = 0; i < LOCK_SITES; ++i)
+        std::fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %zu, "
+                     "\"args\": {\"name\": \"%s\"}}", i, lockSiteName(static_cast<LockSite>(i)));
+    // Times in microseconds; a wait and a hold slice per lock.
+    for (size_t i = 0; i < count; ++i) {
+        const TraceEvent& event = trace[i];
+        const unsigned lane = static_cast<unsigned>(event.site);
+        std::fprintf(file, ",\n{\"name\": \"wait\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}"
+                     ",\n{\"name\": \"hold\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                     lane, event.start * 1e-3, event.wait * 1e-3, lane, (event.start + event.wait) * 1e-3,
+                     event.hold * 1e-3);
+    }
+    std::fprintf(file, "\n]}\n");
+    const bool written = !std::ferror(file);
+    return std::fclose(file) == 0 && written;
+}
+
+TimedLock::TimedLock(std::mutex& mutex, LockStats& stats, LockSite site)
+    : mutex(mutex), stats(stats), site(site), start(stats.now())
+{
+    mutex.lock();
+    acquired = stats.now();
+}
+
+TimedLock::~TimedLock() {
+    const uint64_t released = stats.now();
+    mutex.unlock();
+    stats.record(site, start, acquired - start, released - acquired);
+}
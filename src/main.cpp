@@ -1,36 +1,316 @@
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
-#include <SDL2/SDL2_gfxPrimitives.h>
 #include <iostream>
 #include <thread>
 #include <mutex>
-#include <sstream>
 #include <vector>
-#include <unordered_map>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <memory>
 #include "object.hpp"
 #include "ball.hpp"
 #include "box.hpp"
+#include "world.hpp"
 #include "physics.hpp"
-#include "render.hpp"
-#include "collision.hpp"
-#include "font_data.hpp"
+#include "snapshot.hpp"
+#include "render_thread.hpp"
+#include "headless.hpp"
+#include "scene_file.hpp"
+#include "checkpoint.hpp"
+#include "scene_generator.hpp"
+#include "metrics_exporter.hpp"
 
 constexpr int WINDOW_WIDTH  = 800;
 constexpr int WINDOW_HEIGHT = 600;
 
-// At the global scope or in a manager class
-std::unordered_map<std::string, SDL_Texture*> textCache;
+// Balls of a scene generated with the number keys when --balls is not given.
+constexpr size_t GUI_SCENE_BALLS = 2000;
+// World locks kept for --lock-trace; about 20 minutes of a 240 Hz simulation.
+constexpr size_t LOCK_TRACE_LOCKS = 1 << 19;
+
+// Write the world lock trace if one was requested. Returns false on failure.
+static bool writeLockTrace(const World& world, const std::string& path) {
+    if (path.empty() || world.locks.writeTrace(path))
+        return true;
+    std::cerr << "Cannot write lock trace " << path << "\n";
+    return false;
+}
+
+// Generate a stress scene and add it to the world. Generation runs in parallel
+// without the world mutex; only spawning holds it. With clearFirst the scene
+// replaces the world's objects.
+static void spawnGeneratedScene(World& world, SceneKind kind, size_t count, uint32_t seed, unsigned threads,
+                                bool clearFirst = false) {
+    GeneratedScene scene;
+    {
+        ThreadPool pool(threads);
+        generateScene(kind, count, seed, world.bounds, pool, scene);
+    }
+    TimedLock lock(world.mutex, world.locks, LockSite::SPAWN);
+    if (clearFirst)
+        world.clear();
+    spawnSceneObjects(world, scene.balls.data(), scene.balls.size(), scene.boxes.data(), scene.boxes.size());
+}
 
 int main(int argc, char* argv[]) {
+    PhysicsSettings physicsSettings;
+    LifetimePolicy lifetimePolicy;
+    WorldBounds worldBounds;
+    WorldParams worldParams;
+    size_t initialBalls = 0;
+    SceneKind sceneKind = SceneKind::RAIN;
+    uint32_t sceneSeed = 12345;
+    long benchSteps = 0;
+    std::string scenePath, saveScenePath, resumePath, lockTracePath;
+    bool headless = false;
+    bool cpuRaster = false;
+    bool perfHud = false;
+    LodMode lod = LodMode::HEATMAP;
+    PacingMode pacing = PacingMode::VSYNC;
+    double targetFps = 0.0;
+    HeadlessSettings headlessSettings;
+    MetricsSettings metricsSettings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        // Number of physics worker threads.
+        if (arg == "--threads" && i + 1 < argc) {
+            physicsSettings.threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        }
+        // Size of the world; the camera shows part of it.
+        else if (arg == "--world-width" && i + 1 < argc) {
+            worldBounds.width = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--world-height" && i + 1 < argc) {
+            worldBounds.height = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--walls" && i + 1 < argc) {
+            std::string walls = argv[++i];
+            if (walls == "all")
+                worldBounds.walls = WALLS_ALL;
+            else if (walls == "open-top")
+                worldBounds.walls = WALL_FLOOR | WALL_LEFT | WALL_RIGHT;
+            else if (walls == "floor")
+                worldBounds.walls = WALL_FLOOR;
+            else if (walls == "none")
+                worldBounds.walls = 0;
+            else {
+                std::cerr << "Unknown wall mode: " << walls << "\n";
+                return 1;
+            }
+        }
+        // Start with the XPBD solver instead of impulses.
+        else if (arg == "--xpbd") {
+            physicsSettings.solverMode.store(SolverMode::XPBD);
+        }
+        // Draw objects with the CPU rasterizer.
+        else if (arg == "--cpu-raster") {
+            cpuRaster = true;
+        }
+        // Show the performance graphs.
+        else if (arg == "--perf-hud") {
+            perfHud = true;
+        }
+        // When the render thread starts a frame.
+        else if (arg == "--pacing" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "vsync")
+                pacing = PacingMode::VSYNC;
+            else if (mode == "uncapped")
+                pacing = PacingMode::UNCAPPED;
+            else if (mode == "target")
+                pacing = PacingMode::TARGET;
+            else {
+                std::cerr << "Unknown pacing mode: " << mode << "\n";
+                return 1;
+            }
+        } else if (arg == "--target-fps" && i + 1 < argc) {
+            targetFps = std::max(1.0, std::atof(argv[++i]));
+            pacing = PacingMode::TARGET;
+        }
+        // How to draw balls smaller than a pixel.
+        else if (arg == "--lod" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "off")
+                lod = LodMode::OFF;
+            else if (mode == "points")
+                lod = LodMode::POINTS;
+            else if (mode == "heatmap")
+                lod = LodMode::HEATMAP;
+            else {
+                std::cerr << "Unknown LOD mode: " << mode << "\n";
+                return 1;
+            }
+        }
+        // A generated scene added to the world at startup.
+        else if (arg == "--balls" && i + 1 < argc) {
+            initialBalls = static_cast<size_t>(std::max(0LL, std::atoll(argv[++i])));
+        } else if (arg == "--generate" && i + 1 < argc) {
+            std::string kind = argv[++i];
+            if (!parseSceneKind(kind, sceneKind)) {
+                std::cerr << "Unknown scene kind: " << kind << "\n";
+                return 1;
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            sceneSeed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        // Step without drawing and report the step rate.
+        else if (arg == "--bench" && i + 1 < argc) {
+            benchSteps = std::max(1L, std::atol(argv[++i]));
+        }
+        // Publish metrics for Prometheus.
+        else if (arg == "--metrics-port" && i + 1 < argc) {
+            metricsSettings.port = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            metricsSettings.file = argv[++i];
+        } else if (arg == "--metrics-interval" && i + 1 < argc) {
+            metricsSettings.interval = std::max(0.1f, static_cast<float>(std::atof(argv[++i])));
+        }
+        // Record every lock of the world mutex.
+        else if (arg == "--lock-trace" && i + 1 < argc) {
+            lockTracePath = argv[++i];
+        }
+        // Start from a scene file, or write the starting scene to one and exit.
+        else if (arg == "--scene" && i + 1 < argc) {
+            scenePath = argv[++i];
+        } else if (arg == "--save-scene" && i + 1 < argc) {
+            saveScenePath = argv[++i];
+        }
+        // Save the state of a headless run now and then, and continue from it.
+        else if (arg == "--checkpoint" && i + 1 < argc) {
+            headlessSettings.checkpoint = argv[++i];
+        } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            headlessSettings.checkpointInterval = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--resume" && i + 1 < argc) {
+            resumePath = argv[++i];
+        }
+        // Record a video without opening a window.
+        else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--output" && i + 1 < argc) {
+            headlessSettings.output = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format != "y4m" && format != "rgba") {
+                std::cerr << "Unknown video format: " << format << "\n";
+                return 1;
+            }
+            headlessSettings.format = format == "rgba" ? VideoFormat::RGBA : VideoFormat::Y4M;
+        } else if (arg == "--fps" && i + 1 < argc) {
+            headlessSettings.fps = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--duration" && i + 1 < argc) {
+            headlessSettings.duration = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--video-size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &headlessSettings.width, &headlessSettings.height) != 2 ||
+                headlessSettings.width <= 0 || headlessSettings.height <= 0) {
+                std::cerr << "Invalid video size: " << argv[i] << "\n";
+                return 1;
+            }
+        }
+        // Physical constants of the world.
+        else if (arg == "--gravity" && i + 1 < argc) {
+            worldParams.gravity = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--drag" && i + 1 < argc) {
+            worldParams.airDrag = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--ground-friction" && i + 1 < argc) {
+            worldParams.groundFriction = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--bounce" && i + 1 < argc) {
+            worldParams.bounceDamping = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--friction" && i + 1 < argc) {
+            worldParams.frictionCoefficient = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        }
+        // Rules for removing balls automatically.
+        else if (arg == "--max-balls" && i + 1 < argc) {
+            lifetimePolicy.maxBalls = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--ttl" && i + 1 < argc) {
+            lifetimePolicy.timeToLive = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--sleep-timeout" && i + 1 < argc) {
+            lifetimePolicy.sleepTimeout = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--offworld-timeout" && i + 1 < argc) {
+            lifetimePolicy.offWorldTimeout = static_cast<float>(std::atof(argv[++i]));
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // All objects live in the world; its mutex is shared with the physics thread.
+    World world;
+    if (!lockTracePath.empty())
+        world.locks.startTrace(LOCK_TRACE_LOCKS);
+    world.bounds = worldBounds;
+    world.params = worldParams;
+    world.lifetime = lifetimePolicy;
+    // A checkpoint replaces any other way of setting up the scene.
+    Checkpoint resume;
+    if (!resumePath.empty()) {
+        std::string error;
+        if (!readCheckpoint(resumePath, resume, error)) {
+            std::cerr << "Cannot resume: " << error << "\n";
+            return 1;
+        }
+        world.restoreState(resume.world);
+        worldBounds = world.bounds;
+        worldParams = world.params;
+        physicsSettings.solverMode.store(resume.mode);
+    } else {
+        if (!scenePath.empty()) {
+            std::string error;
+            if (!loadScene(scenePath, world, error)) {
+                std::cerr << "Cannot load scene: " << error << "\n";
+                return 1;
+            }
+            worldBounds = world.bounds;
+        }
+        if (initialBalls > 0)
+            spawnGeneratedScene(world, sceneKind, initialBalls, sceneSeed, physicsSettings.threads);
+    }
+
+    if (!saveScenePath.empty()) {
+        const bool saved = saveScene(saveScenePath, world);
+        if (!saved)
+            std::cerr << "Cannot write scene " << saveScenePath << "\n";
+        world.clear();
+        return saved ? 0 : 1;
+    }
+
+    // Snapshots from the physics thread, for drawing and for the metrics.
+    SnapshotBuffer snapshots;
+    // Metrics are only collected when something publishes them.
+    Metrics metrics;
+    std::unique_ptr<MetricsExporter> exporter;
+    if (metricsSettings.port > 0 || !metricsSettings.file.empty()) {
+        physicsSettings.metrics = &metrics;
+        metrics.locks = &world.locks;
+        metrics.snapshots = &snapshots;
+        exporter.reset(new MetricsExporter(metrics, metricsSettings));
+        if (!exporter->start()) {
+            world.clear();
+            return 1;
+        }
+    }
+
+    if (benchSteps > 0) {
+        int result = runBenchmark(world, physicsSettings, benchSteps);
+        world.clear();
+        return writeLockTrace(world, lockTracePath) ? result : 1;
+    }
+
+    if (headless) {
+        ViewState view;
+        view.camera.fit(worldBounds, headlessSettings.width, headlessSettings.height);
+        view.xpbd = physicsSettings.solverMode.load() == SolverMode::XPBD;
+        view.cpuRaster = cpuRaster;
+        view.lod = lod;
+        int result = runHeadless(world, physicsSettings, view, headlessSettings,
+                                 resumePath.empty() ? nullptr : &resume);
+        world.clear();
+        return writeLockTrace(world, lockTracePath) ? result : 1;
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "SDL_Init Error: " << SDL_GetError() << "\n";
         return 1;
     }
-    if (TTF_Init() != 0) {
-        std::cerr << "TTF_Init Error: " << TTF_GetError() << "\n";
-        SDL_Quit();
-        return 1;
-    }
     SDL_Window* window = SDL_CreateWindow("JPS",
                                           SDL_WINDOWPOS_CENTERED,
                                           SDL_WINDOWPOS_CENTERED,
@@ -38,268 +318,207 @@ int main(int argc, char* argv[]) {
                                           SDL_WINDOW_SHOWN);
     if (!window) {
          std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << "\n";
-         TTF_Quit();
-         SDL_Quit();
-         return 1;
-    }
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, 
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!renderer) {
-         std::cerr << "SDL_CreateRenderer Error: " << SDL_GetError() << "\n";
-         SDL_DestroyWindow(window);
-         TTF_Quit();
          SDL_Quit();
          return 1;
     }
 
-    // Instead of loading the font from disk, create an SDL_RWops from the embedded font data.
-    SDL_RWops *rw = SDL_RWFromConstMem(rsc_SNPro_Regular_ttf, rsc_SNPro_Regular_ttf_len);
-    if (!rw) {
-        std::cerr << "SDL_RWFromConstMem Error: " << SDL_GetError() << "\n";
-        SDL_DestroyRenderer(renderer);
+    // Frames are drawn on their own thread from the physics snapshots, so
+    // this thread only has to handle events.
+    RenderThread renderThread(window, worldBounds, snapshots, pacing, targetFps, physicsSettings.metrics,
+                              &world.locks);
+    if (!renderThread.start()) {
         SDL_DestroyWindow(window);
-        TTF_Quit();
         SDL_Quit();
         return 1;
     }
-    // Open the font from the RWops; the "1" flag tells SDL_ttf to free the RWops for us.
-    TTF_Font* font = TTF_OpenFontRW(rw, 1, 32);
-    if (!font) {
-        std::cerr << "TTF_OpenFont Error: " << TTF_GetError() << "\n";
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        TTF_Quit();
-        SDL_Quit();
-        return 1;
-    }
-
-    // Store objects as pointers to the base class.
-    std::vector<Object*> objects;
-    std::mutex objectsMutex;
 
     // Start the physics thread.
     bool simulationRunning = true;
     std::thread physicsThread(physicsThreadFunction, std::ref(simulationRunning),
-                              std::ref(objects), std::ref(objectsMutex));
+                              std::ref(world), std::ref(physicsSettings), std::ref(snapshots));
 
     bool quit = false;
     SDL_Event event;
 
-    // Variables for spawning objects using mouse drag.
-    bool dragging = false;
-    int dragStartX = 0, dragStartY = 0;
-    int currentDragX = 0, currentDragY = 0;
+    // Toggles, the spawn drag and the selection, shared with the render thread.
+    ViewState view;
+    view.camera.fit(worldBounds, WINDOW_WIDTH, WINDOW_HEIGHT);
+    view.xpbd = physicsSettings.solverMode.load() == SolverMode::XPBD;
+    view.cpuRaster = cpuRaster;
+    view.lod = lod;
+    view.perfHud = perfHud;
     constexpr float VELOCITY_MULTIPLIER = 3.0f;
-    
-    // Mode flag: if true, user is creating a box by dragging, else a ball.
-    bool previewBoxMode = false;
-    
-    // Toggle for showing velocity info above Balls.
-    bool showVelocityInfo = false;
-    // Toggle for debug mode
-    bool debugMode = false;
+    // Zoom per mouse wheel notch, and the part of the view an arrow key pans.
+    constexpr float ZOOM_STEP = 1.1f;
+    constexpr float PAN_STEP = 0.1f;
 
-    Uint32 fpsTimer = SDL_GetTicks();
-    int frames = 0;
-    float currentFPS = 0.0f;
+    // Camera panning with the middle mouse button.
+    bool panning = false;
+    int panX = 0, panY = 0;
 
-    while (!quit) {
-        Uint32 frameStart = SDL_GetTicks();
-        while(SDL_PollEvent(&event)) {
-            switch(event.type) {
-                case SDL_QUIT:
-                    quit = true;
-                    break;
-                case SDL_KEYDOWN:
-                    // Toggle velocity info with V key.
-                    if (event.key.keysym.sym == SDLK_v)
-                        showVelocityInfo = !showVelocityInfo;
-                    // Toggle debug mode with D key
-                    else if (event.key.keysym.sym == SDLK_d)
-                        debugMode = !debugMode;
-                    break;
-                case SDL_MOUSEBUTTONDOWN:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        dragging = true;
-                        dragStartX = event.button.x;
-                        dragStartY = event.button.y;
-                        currentDragX = event.button.x;
-                        currentDragY = event.button.y;
-                        // Check modifier key: if SHIFT is held at start then set box mode.
-                        previewBoxMode = (SDL_GetModState() & KMOD_SHIFT) != 0;
-                    }
-                    break;
-                case SDL_MOUSEMOTION:
-                    if (dragging) {
-                        currentDragX = event.motion.x;
-                        currentDragY = event.motion.y;
-                    }
-                    break;
-                case SDL_MOUSEBUTTONUP:
-                    if (dragging && event.button.button == SDL_BUTTON_LEFT) {
-                        dragging = false;
-                        int dragEndX = event.button.x;
-                        int dragEndY = event.button.y;
-                        if (previewBoxMode) {
-                            // For box creation, determine width and height from drag.
-                            int width = std::abs(dragEndX - dragStartX);
-                            int height = std::abs(dragEndY - dragStartY);
-                            // Avoid creating zero-sized boxes.
-                            if(width < 5) width = 5;
-                            if(height < 5) height = 5;
-                            // Set center to the midpoint.
-                            float centerX = (dragStartX + dragEndX) / 2.0f;
-                            float centerY = (dragStartY + dragEndY) / 2.0f;
-                            // Create a new Box with specified size.
-                            Object* newObj = new Box(centerX, centerY, static_cast<float>(width), static_cast<float>(height));
-                            {
-                                std::lock_guard<std::mutex> lock(objectsMutex);
-                                objects.push_back(newObj);
-                            }
-                        } else {
-                            // For ball creation, use drag vector to determine initial velocity.
-                            float vx = (dragEndX - dragStartX) * VELOCITY_MULTIPLIER;
-                            float vy = (dragEndY - dragStartY) * VELOCITY_MULTIPLIER;
-                            Object* newObj = new Ball(static_cast<float>(dragStartX),
-                                                      static_cast<float>(dragStartY),
-                                                      vx, vy, 20.0f);
-                            {
-                                std::lock_guard<std::mutex> lock(objectsMutex);
-                                objects.push_back(newObj);
-                            }
-                        }
-                    }
-                    break;
-            }
-        }
-        // Clear the screen.
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-        
-        // Draw ground line.
-        SDL_SetRenderDrawColor(renderer, 150, 75, 0, 255);
-        SDL_RenderDrawLine(renderer, 0, WINDOW_HEIGHT - 1, WINDOW_WIDTH, WINDOW_HEIGHT - 1);
-        
-        // Draw preview if dragging in box creation mode.
-        if (dragging && previewBoxMode) {
-            // Compute rectangle: top-left and dimensions.
-            int rectX = std::min(dragStartX, currentDragX);
-            int rectY = std::min(dragStartY, currentDragY);
-            int rectW = std::abs(currentDragX - dragStartX);
-            int rectH = std::abs(currentDragY - dragStartY);
-            SDL_Rect previewRect = { rectX, rectY, rectW, rectH };
-            
-            // Semi-transparent fill
-            SDL_SetRenderDrawColor(renderer, 0, 255, 0, 100);
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            SDL_RenderFillRect(renderer, &previewRect);
-            
-            // Solid border
-            SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-            SDL_RenderDrawRect(renderer, &previewRect);
-        }
-        // If dragging and not in box mode, draw the drag vector for ball creation.
-        else if (dragging && !previewBoxMode) {
-            SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-            // Use SDL2_gfx for anti-aliased lines
-            aalineRGBA(renderer, dragStartX, dragStartY, currentDragX, currentDragY, 0, 255, 0, 255);
-        }
-        
-        // Render all objects.
-        {
-            std::lock_guard<std::mutex> lock(objectsMutex);
-            for (const auto obj : objects) {
-                if (obj->type == ObjectType::BALL)
-                    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-                else
-                    SDL_SetRenderDrawColor(renderer, 180, 180, 180, 255);
-                obj->render(renderer);
-                
-                // Show velocity info if enabled
-                if (showVelocityInfo && obj->type == ObjectType::BALL)
-                    obj->renderVelocityInfo(renderer, font);
-                
-                // Show debug info if debug mode is enabled
-                if (debugMode)
-                    renderDebugInfo(renderer, font, obj);
-            }
-        }
-        
-        // Calculate and render FPS.
-        frames++;
-        Uint32 currentTicks = SDL_GetTicks();
-        if (currentTicks - fpsTimer >= 1000) {
-            currentFPS = frames * 1000.0f / (currentTicks - fpsTimer);
-            fpsTimer = currentTicks;
-            frames = 0;
-        }
-
-        std::stringstream fpsText;
-        fpsText << "FPS: " << static_cast<int>(currentFPS);
-        SDL_Color white = {255, 255, 255, 255};
+    // Results of the last selection query.
+    std::vector<size_t> queryResults;
 
-        // FPS text rendering with proper texture caching
-        std::string fpsTextStr = fpsText.str();
-        SDL_Texture* fpsTexture = nullptr;
-        int textWidth = 0, textHeight = 0;
-
-        // Check if we already have this text cached
-        if (textCache.find(fpsTextStr) != textCache.end()) {
-            fpsTexture = textCache[fpsTextStr];
-            // Query the texture to get its width and height
-            SDL_QueryTexture(fpsTexture, nullptr, nullptr, &textWidth, &textHeight);
-        } else {
-            SDL_Surface* fpsSurface = TTF_RenderText_Blended(font, fpsTextStr.c_str(), white);
-            if (fpsSurface) {
-                textWidth = fpsSurface->w;
-                textHeight = fpsSurface->h;
-                fpsTexture = SDL_CreateTextureFromSurface(renderer, fpsSurface);
-                textCache[fpsTextStr] = fpsTexture;
-                SDL_FreeSurface(fpsSurface);
+    while (!quit && SDL_WaitEvent(&event)) {
+        switch(event.type) {
+            case SDL_QUIT:
+                quit = true;
+                break;
+            case SDL_KEYDOWN:
+                // Toggle velocity info with V key.
+                if (event.key.keysym.sym == SDLK_v)
+                    view.showVelocityInfo = !view.showVelocityInfo;
+                // Toggle debug mode with D key
+                else if (event.key.keysym.sym == SDLK_d)
+                    view.debugMode = !view.debugMode;
+                // Toggle filled balls with F key
+                else if (event.key.keysym.sym == SDLK_f)
+                    view.filledBalls = !view.filledBalls;
+                // Toggle sprite or mesh balls with R key
+                else if (event.key.keysym.sym == SDLK_r)
+                    view.spriteBalls = !view.spriteBalls;
+                // Toggle the CPU rasterizer with C key
+                else if (event.key.keysym.sym == SDLK_c)
+                    view.cpuRaster = !view.cpuRaster;
+                // Cycle through the LOD modes with L key
+                else if (event.key.keysym.sym == SDLK_l)
+                    view.lod = view.lod == LodMode::OFF ? LodMode::POINTS
+                             : view.lod == LodMode::POINTS ? LodMode::HEATMAP : LodMode::OFF;
+                // Remove the selected object with Delete key
+                else if (event.key.keysym.sym == SDLK_DELETE) {
+                    TimedLock lock(world.mutex, world.locks, LockSite::EDIT);
+                    world.despawn(view.selectedObject);
+                }
+                // Pan with the arrow keys, show the whole world with Home
+                else if (event.key.keysym.sym == SDLK_LEFT)
+                    view.camera.pan(-PAN_STEP * WINDOW_WIDTH, 0.0f);
+                else if (event.key.keysym.sym == SDLK_RIGHT)
+                    view.camera.pan(PAN_STEP * WINDOW_WIDTH, 0.0f);
+                else if (event.key.keysym.sym == SDLK_UP)
+                    view.camera.pan(0.0f, -PAN_STEP * WINDOW_HEIGHT);
+                else if (event.key.keysym.sym == SDLK_DOWN)
+                    view.camera.pan(0.0f, PAN_STEP * WINDOW_HEIGHT);
+                else if (event.key.keysym.sym == SDLK_HOME)
+                    view.camera.fit(worldBounds, WINDOW_WIDTH, WINDOW_HEIGHT);
+                // Switch between the impulse and the XPBD solver with S key
+                else if (event.key.keysym.sym == SDLK_s) {
+                    view.xpbd = physicsSettings.solverMode.load() != SolverMode::XPBD;
+                    physicsSettings.solverMode.store(view.xpbd ? SolverMode::XPBD : SolverMode::IMPULSE);
+                }
+                // Replace the world with a generated scene with keys 1 to 5
+                else if (event.key.keysym.sym >= SDLK_1 && event.key.keysym.sym <= SDLK_5) {
+                    const SceneKind kind = static_cast<SceneKind>(event.key.keysym.sym - SDLK_1);
+                    spawnGeneratedScene(world, kind, initialBalls > 0 ? initialBalls : GUI_SCENE_BALLS, sceneSeed,
+                                        physicsSettings.threads, true);
+                    view.selectedObject = ObjectHandle();
+                }
+                // Toggle the performance graphs with P key
+                else if (event.key.keysym.sym == SDLK_p)
+                    view.perfHud = !view.perfHud;
+                // Switch gravity off and back on with G key
+                else if (event.key.keysym.sym == SDLK_g) {
+                    TimedLock lock(world.mutex, world.locks, LockSite::EDIT);
+                    // Started with --gravity 0: switch on the default gravity
+                    const float on = worldParams.hasGravity() ? worldParams.gravity : WorldParams().gravity;
+                    world.params.gravity = world.params.hasGravity() ? 0.0f : on;
+                }
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+                if (event.button.button == SDL_BUTTON_LEFT) {
+                    view.dragging = true;
+                    view.dragStartX = event.button.x;
+                    view.dragStartY = event.button.y;
+                    view.currentDragX = event.button.x;
+                    view.currentDragY = event.button.y;
+                    // Check modifier key: if SHIFT is held at start then set box mode.
+                    view.previewBoxMode = (SDL_GetModState() & KMOD_SHIFT) != 0;
+                }
+                // Select the object under the mouse, using the latest physics snapshot.
+                else if (event.button.button == SDL_BUTTON_RIGHT) {
+                    view.selectedObject = ObjectHandle();
+                    std::shared_ptr<const WorldSnapshot> snapshot = snapshots.latest();
+                    if (snapshot) {
+                        snapshot->index().queryPoint(view.camera.toWorldX(static_cast<float>(event.button.x)),
+                                                     view.camera.toWorldY(static_cast<float>(event.button.y)),
+                                                     queryResults);
+                        // Later objects are drawn on top, so prefer the last hit.
+                        if (!queryResults.empty())
+                            view.selectedObject = snapshot->objects[queryResults.back()].handle;
+                    }
+                }
+                else if (event.button.button == SDL_BUTTON_MIDDLE) {
+                    panning = true;
+                    panX = event.button.x;
+                    panY = event.button.y;
+                }
+                break;
+            case SDL_MOUSEMOTION:
+                if (view.dragging) {
+                    view.currentDragX = event.motion.x;
+                    view.currentDragY = event.motion.y;
+                }
+                if (panning) {
+                    view.camera.pan(static_cast<float>(panX - event.motion.x),
+                                    static_cast<float>(panY - event.motion.y));
+                    panX = event.motion.x;
+                    panY = event.motion.y;
+                }
+                break;
+            case SDL_MOUSEWHEEL: {
+                // Zoom around the mouse cursor.
+                int mouseX, mouseY;
+                SDL_GetMouseState(&mouseX, &mouseY);
+                view.camera.zoomAt(static_cast<float>(mouseX), static_cast<float>(mouseY),
+                                   std::pow(ZOOM_STEP, static_cast<float>(event.wheel.y)));
+                break;
             }
+            case SDL_MOUSEBUTTONUP:
+                if (event.button.button == SDL_BUTTON_MIDDLE)
+                    panning = false;
+                if (view.dragging && event.button.button == SDL_BUTTON_LEFT) {
+                    view.dragging = false;
+                    // The drag is in window pixels; objects are spawned in world units.
+                    const Camera& camera = view.camera;
+                    float startX = camera.toWorldX(static_cast<float>(view.dragStartX));
+                    float startY = camera.toWorldY(static_cast<float>(view.dragStartY));
+                    float endX = camera.toWorldX(static_cast<float>(event.button.x));
+                    float endY = camera.toWorldY(static_cast<float>(event.button.y));
+                    if (view.previewBoxMode) {
+                        // For box creation, determine width and height from drag.
+                        float width = std::fabs(endX - startX);
+                        float height = std::fabs(endY - startY);
+                        // Avoid creating zero-sized boxes.
+                        if(width < 5) width = 5;
+                        if(height < 5) height = 5;
+                        // Set center to the midpoint.
+                        float centerX = (startX + endX) / 2.0f;
+                        float centerY = (startY + endY) / 2.0f;
+                        // Create a new Box with specified size.
+                        TimedLock lock(world.mutex, world.locks, LockSite::SPAWN);
+                        world.spawnBox(centerX, centerY, width, height);
+                    } else {
+                        // For ball creation, use drag vector to determine initial velocity.
+                        float vx = (endX - startX) * VELOCITY_MULTIPLIER;
+                        float vy = (endY - startY) * VELOCITY_MULTIPLIER;
+                        TimedLock lock(world.mutex, world.locks, LockSite::SPAWN);
+                        world.spawnBall(startX, startY, vx, vy, 20.0f);
+                    }
+                }
+                break;
         }
-
-        if (fpsTexture) {
-            // First draw shadow
-            SDL_SetTextureColorMod(fpsTexture, 0, 0, 0);
-            SDL_SetTextureAlphaMod(fpsTexture, 128);
-            SDL_Rect shadowRect = {12, 12, textWidth, textHeight};
-            SDL_RenderCopy(renderer, fpsTexture, nullptr, &shadowRect);
-            
-            // Then draw text
-            SDL_SetTextureColorMod(fpsTexture, 255, 255, 255);
-            SDL_SetTextureAlphaMod(fpsTexture, 255);
-            SDL_Rect dstRect = {10, 10, textWidth, textHeight};
-            SDL_RenderCopy(renderer, fpsTexture, nullptr, &dstRect);
-        }
-        SDL_RenderPresent(renderer);
-
-        Uint32 frameTime = SDL_GetTicks() - frameStart;
-        if (frameTime < 16)
-            SDL_Delay(16 - frameTime);
+        renderThread.setView(view);
     }
+    renderThread.stop();
     simulationRunning = false;
     physicsThread.join();
 
-    // Clean up dynamically allocated objects.
+    // Destroy all objects.
     {
-        std::lock_guard<std::mutex> lock(objectsMutex);
-        for (auto obj : objects)
-            delete obj;
-        objects.clear();
-    }
-
-    // Clean up texture cache
-    for (auto& pair : textCache) {
-        SDL_DestroyTexture(pair.second);
+        TimedLock lock(world.mutex, world.locks, LockSite::EDIT);
+        world.clear();
     }
-    textCache.clear();
 
-    TTF_CloseFont(font);
-    SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
-    TTF_Quit();
     SDL_Quit();
-    return 0;
-}
\ No newline at end of file
+    return writeLockTrace(world, lockTracePath) ? 0 : 1;
+}
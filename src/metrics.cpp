@@ -0,0 +1,152 @@
+#include "metrics.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+
+LatencyHistogram::LatencyHistogram(std::initializer_list<double> bounds)
+    : bounds(bounds), counts(new std::atomic<uint64_t>[bounds.size() + 1])
+{
+    for (size_t i = 0; i <= this->bounds.size(); ++i)
+        counts[i].store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::observe(double seconds) {
+    const size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), seconds) - bounds.begin();
+    counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    sumNanos.fetch_add(static_cast<uint64_t>(std::max(0.0, seconds) * 1e9), std::memory_order_relaxed);
+}
+
+void LatencyHistogram::write(std::string& out, const char* name, const char* help) const {
+    char line[160];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    out += line;
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= bounds.size(); ++i) {
+        cumulative += counts[i].load(std::memory_order_relaxed);
+        if (i < bounds.size())
+            std::snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", name, bounds[i],
+                          static_cast<unsigned long long>(cumulative));
+        else
+            std::snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n", name,
+                          static_cast<unsigned long long>(cumulative));
+        out += line;
+    }
+    std::snprintf(line, sizeof(line), "%s_sum %.9f\n%s_count %llu\n", name,
+                  sumNanos.load(std::memory_order_relaxed) * 1e-9, name, static_cast<unsigned long long>(cumulative));
+    out += line;
+}
+
+Metrics::Metrics()
+    : stepDuration({0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1}),
+      frameDuration({0.004, 0.008, 0.0125, 0.017, 0.025, 0.034, 0.05, 0.1, 0.25})
+{}
+
+// Balls, boxes and balls at rest in a snapshot.
+static void countObjects(const WorldSnapshot& snapshot, uint32_t& ballCount, uint32_t& boxCount,
+                         uint32_t& sleepingCount) {
+    ballCount = sleepingCount = 0;
+    for (const ObjectState& obj : snapshot.objects) {
+        if (obj.type != ObjectType::BALL)
+            continue;
+        ballCount++;
+        if (std::fabs(obj.vx) < REST_SPEED && std::fabs(obj.vy) < REST_SPEED)
+            sleepingCount++;
+    }
+    boxCount = static_cast<uint32_t>(snapshot.objects.size()) - ballCount;
+}
+
+void Metrics::recordObjects(const WorldSnapshot& snapshot) {
+    uint32_t ballCount, boxCount, sleepingCount;
+    countObjects(snapshot, ballCount, boxCount, sleepingCount);
+    balls.store(ballCount, std::memory_order_relaxed);
+    boxes.store(boxCount, std::memory_order_relaxed);
+    sleeping.store(sleepingCount, std::memory_order_relaxed);
+}
+
+// Append the wait or hold histograms of every lock site as one labelled metric.
+static void writeLockHistograms(std::string& out, const LockStats& locks, bool hold, const char* name,
+                                const char* help) {
+    char line[192];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    out += line;
+    for (size_t s = 0; s < LOCK_SITES; ++s) {
+        const char* site = lockSiteName(static_cast<LockSite>(s));
+        LockStats::Counts counts;
+        locks.read(static_cast<LockSite>(s), counts);
+        const uint64_t* buckets = hold ? counts.hold : counts.wait;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < LockStats::BUCKETS; ++i) {
+            cumulative += buckets[i];
+            const uint64_t limit = LockStats::bucketLimit(i);
+            if (limit > 0)
+                std::snprintf(line, sizeof(line), "%s_bucket{site=\"%s\",le=\"%g\"} %llu\n", name, site, limit * 1e-9,
+                              static_cast<unsigned long long>(cumulative));
+            else
+                std::snprintf(line, sizeof(line), "%s_bucket{site=\"%s\",le=\"+Inf\"} %llu\n", name, site,
+                              static_cast<unsigned long long>(cumulative));
+            out += line;
+        }
+        std::snprintf(line, sizeof(line), "%s_sum{site=\"%s\"} %.9f\n%s_count{site=\"%s\"} %llu\n", name, site,
+                      (hold ? counts.holdNanos : counts.waitNanos) * 1e-9, name, site,
+                      static_cast<unsigned long long>(cumulative));
+        out += line;
+    }
+}
+
+// Append a gauge or counter with one sample.
+static void writeValue(std::string& out, const char* name, const char* type, const char* help, double value) {
+    char line[192];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n", name, help, name, type, name, value);
+    out += line;
+}
+
+std::string Metrics::expose() const {
+    std::string out;
+    out.reserve(16384);
+    stepDuration.write(out, "simulation_step_duration_seconds", "Time of one physics step.");
+    frameDuration.write(out, "simulation_frame_duration_seconds", "Time between two presented frames.");
+    writeValue(out, "simulation_mutex_wait_seconds_total", "counter",
+               "Time the physics thread waited for the world mutex.",
+               mutexWaitNanos.load(std::memory_order_relaxed) * 1e-9);
+    if (locks) {
+        writeLockHistograms(out, *locks, false, "simulation_world_lock_wait_seconds",
+                            "Time spent waiting for the world mutex, by call site.");
+        writeLockHistograms(out, *locks, true, "simulation_world_lock_hold_seconds",
+                            "Time the world mutex was held, by call site.");
+    }
+
+    // Counted here, on the exporter's thread, so the physics thread never scans the objects for it.
+    uint32_t ballCount = balls.load(std::memory_order_relaxed);
+    uint32_t boxCount = boxes.load(std::memory_order_relaxed);
+    uint32_t sleepingCount = sleeping.load(std::memory_order_relaxed);
+    if (snapshots) {
+        if (std::shared_ptr<const WorldSnapshot> snapshot = snapshots->latest())
+            countObjects(*snapshot, ballCount, boxCount, sleepingCount);
+    }
+    char line[160];
+    out += "# HELP simulation_objects Objects in the world.\n# TYPE simulation_objects gauge\n";
+    std::snprintf(line, sizeof(line), "simulation_objects{type=\"ball\"} %u\nsimulation_objects{type=\"box\"} %u\n",
+                  ballCount, boxCount);
+    out += line;
+    writeValue(out, "simulation_sleeping_balls", "gauge", "Balls at rest.", sleepingCount);
+    writeValue(out, "simulation_contacts", "gauge", "Contacts found by the last physics step.",
+               contacts.load(std::memory_order_relaxed));
+
+    // Sizes in pages: total program size, then resident set.
+    unsigned long long sizePages = 0, residentPages = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(statm, "%llu %llu", &sizePages, &residentPages) != 2)
+            sizePages = residentPages = 0;
+        std::fclose(statm);
+    }
+    const double pageSize = static_cast<double>(sysconf(_SC_PAGESIZE));
+    // Not process_*: node_exporter's textfile collector would reject those as
+    // duplicates of its own process metrics.
+    writeValue(out, "simulation_resident_memory_bytes", "gauge", "Resident memory size of the simulation in bytes.",
+               residentPages * pageSize);
+    writeValue(out, "simulation_virtual_memory_bytes", "gauge", "Virtual memory size of the simulation in bytes.",
+               sizePages * pageSize);
+    return out;
+}
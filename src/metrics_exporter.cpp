@@ -0,0 +1,134 @@
+#include "metrics_exporter.hpp"
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// How often the thread checks whether it should stop, in milliseconds.
+constexpr int POLL_INTERVAL = 100;
+// A scrape that sends nothing for this long is dropped, in milliseconds.
+constexpr int REQUEST_TIMEOUT = 1000;
+
+MetricsExporter::MetricsExporter(const Metrics& metrics, const MetricsSettings& settings)
+    : metrics(metrics), settings(settings)
+{}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start() {
+    if (settings.port > 0) {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(settings.port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listener < 0 || setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+            bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 8) != 0) {
+            std::cerr << "Cannot serve metrics on port " << settings.port << ": " << std::strerror(errno) << "\n";
+            if (listener >= 0)
+                close(listener);
+            listener = -1;
+            return false;
+        }
+    }
+    running = true;
+    thread = std::thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!running)
+        return;
+    running = false;
+    thread.join();
+    if (listener >= 0)
+        close(listener);
+    listener = -1;
+    if (!settings.file.empty() && !writeFile())
+        std::cerr << "Cannot write metrics to " << settings.file << "\n";
+}
+
+void MetricsExporter::run() {
+    auto nextWrite = std::chrono::steady_clock::now();
+    bool fileFailed = false;
+    while (running) {
+        if (!settings.file.empty() && std::chrono::steady_clock::now() >= nextWrite) {
+            // Report a failing file once, not every interval.
+            const bool written = writeFile();
+            if (!written && !fileFailed)
+                std::cerr << "Cannot write metrics to " << settings.file << "\n";
+            fileFailed = !written;
+            nextWrite += std::chrono::milliseconds(static_cast<long>(settings.interval * 1000.0f));
+        }
+        if (listener < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL));
+            continue;
+        }
+        pollfd fd = {listener, POLLIN, 0};
+        if (poll(&fd, 1, POLL_INTERVAL) > 0 && (fd.revents & POLLIN))
+            serve();
+    }
+}
+
+void MetricsExporter::serve() {
+    int client = accept(listener, nullptr, nullptr);
+    if (client < 0)
+        return;
+    timeval timeout = {REQUEST_TIMEOUT / 1000, (REQUEST_TIMEOUT % 1000) * 1000};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Read up to the end of the headers; only the request line matters.
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+            break;
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::string body, status;
+    if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0) {
+        status = "200 OK";
+        body = metrics.expose();
+    } else {
+        status = "404 Not Found";
+        body = "Metrics are at /metrics\n";
+    }
+    std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+            break;
+        sent += static_cast<size_t>(n);
+    }
+    close(client);
+}
+
+bool MetricsExporter::writeFile() const {
+    const std::string body = metrics.expose();
+    const std::string temporary = settings.file + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(body.data(), 1, body.size(), file) == body.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), settings.file.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#include "object_pool.hpp"
+#include <algorithm>
+
+constexpr size_t ObjectPool::CHUNK_SIZE;
+
+uint32_t ObjectPool::allocateSlot() {
+    if (!freeSlots.empty()) {
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+        return index;
+    }
+    if (usedSlots == capacity())
+        reserve(capacity() + 1);
+    return usedSlots++;
+}
+
+bool ObjectPool::destroy(ObjectHandle handle) {
+    if (!get(handle))
+        return false;
+    Slot& slot = slotAt(handle.index);
+    slot.object->~Object();
+    slot.object = nullptr;
+    // Skip 0 on wrap-around so zero-initialised handles stay invalid.
+    if (++slot.generation == 0)
+        slot.generation = 1;
+    // Capacity for every slot was reserved with the chunk, so this never allocates.
+    freeSlots.push_back(handle.index);
+    liveCount--;
+    return true;
+}
+
+Object* ObjectPool::get(ObjectHandle handle) const {
+    if (handle.index >= usedSlots)
+        return nullptr;
+    const Slot& slot = slotAt(handle.index);
+    if (!slot.object || slot.generation != handle.generation)
+        return nullptr;
+    return slot.object;
+}
+
+void ObjectPool::reserve(size_t count) {
+    while (capacity() < count)
+        chunks.emplace_back(new Slot[CHUNK_SIZE]);
+    // At least double, so adding one chunk at a time does not copy the list every time.
+    if (freeSlots.capacity() < capacity())
+        freeSlots.reserve(std::max(capacity(), 2 * freeSlots.capacity()));
+}
+
+void ObjectPool::clear() {
+    for (uint32_t index = 0; index < usedSlots; ++index) {
+        Slot& slot = slotAt(index);
+        if (!slot.object)
+            continue;
+        destroy(slot.object->handle);
+    }
+}
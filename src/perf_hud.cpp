@@ -0,0 +1,192 @@
+#include "perf_hud.hpp"
+#include <algorithm>
+#include <cstdio>
+
+// Height of the graph below each label, in pixels.
+constexpr float GRAPH_HEIGHT = 36.0f;
+// Space between two panels and around the contents of a panel.
+constexpr float PANEL_GAP = 4.0f;
+// Height of the bars of a lock histogram, in pixels.
+constexpr float LOCK_BAR_HEIGHT = 20.0f;
+// Time the lock histograms cover, in milliseconds.
+constexpr float LOCK_WINDOW_MS = 1000.0f;
+
+constexpr size_t PerfHud::HISTORY;
+constexpr float PerfHud::WIDTH;
+
+PerfHud::PerfHud() {
+    for (std::vector<float>& series : samples)
+        series.assign(HISTORY, 0.0f);
+}
+
+void PerfHud::addSample(float frameMs, const PhysicsStats& physics, const LockStats* locks) {
+    samples[FRAME_MS][next] = frameMs;
+    samples[INTEGRATE_MS][next] = physics.integrateMs;
+    samples[DETECT_MS][next] = physics.detectMs;
+    samples[SOLVE_MS][next] = physics.solveMs;
+    samples[STEPS_PER_SECOND][next] = physics.stepsPerSecond;
+    samples[OBJECTS][next] = static_cast<float>(physics.objects);
+    samples[CONTACTS][next] = static_cast<float>(physics.contacts);
+    samples[MUTEX_WAIT_MS][next] = physics.mutexWaitMs;
+    next = (next + 1) % HISTORY;
+    count = std::min(count + 1, HISTORY);
+
+    if (!locks)
+        return;
+    lockElapsedMs += frameMs;
+    if (hasLocks && lockElapsedMs < LOCK_WINDOW_MS)
+        return;
+    for (size_t s = 0; s < LOCK_SITES; ++s) {
+        LockStats::Counts current;
+        locks->read(static_cast<LockSite>(s), current);
+        if (hasLocks) {
+            LockStats::Counts& window = lockWindow[s];
+            for (size_t i = 0; i < LockStats::BUCKETS; ++i) {
+                window.wait[i] = current.wait[i] - lockStart[s].wait[i];
+                window.hold[i] = current.hold[i] - lockStart[s].hold[i];
+            }
+            window.waitNanos = current.waitNanos - lockStart[s].waitNanos;
+            window.holdNanos = current.holdNanos - lockStart[s].holdNanos;
+            window.locks = current.locks - lockStart[s].locks;
+        }
+        lockStart[s] = current;
+    }
+    lockWindowMs = lockElapsedMs;
+    lockElapsedMs = 0.0f;
+    hasLocks = true;
+}
+
+// Upper bound of the bucket holding the 99th percentile, as text.
+static void formatPercentile(char* out, size_t size, const uint64_t* buckets, uint64_t total) {
+    if (total == 0) {
+        std::snprintf(out, size, "-");
+        return;
+    }
+    uint64_t cumulative = 0;
+    size_t i = 0;
+    for (; i + 1 < LockStats::BUCKETS; ++i) {
+        cumulative += buckets[i];
+        if (cumulative * 100 >= total * 99)
+            break;
+    }
+    const uint64_t limit = LockStats::bucketLimit(i);
+    const uint64_t nanos = limit > 0 ? limit : LockStats::bucketLimit(i - 1);
+    const char* prefix = limit > 0 ? "" : ">";
+    if (nanos < 1000000)
+        std::snprintf(out, size, "%s%llu us", prefix, static_cast<unsigned long long>(nanos / 1000));
+    else
+        std::snprintf(out, size, "%s%.1f ms", prefix, nanos * 1e-6);
+}
+
+float PerfHud::sample(Series series, size_t i) const {
+    return samples[series][(next + HISTORY - count + i) % HISTORY];
+}
+
+float PerfHud::stacked(Series first, Series last, size_t i) const {
+    float sum = 0.0f;
+    for (int s = first; s <= last; ++s)
+        sum += sample(static_cast<Series>(s), i);
+    return sum;
+}
+
+void PerfHud::record(CommandBuffer& commands, const TextRenderer& text, float x, float y) const {
+    const float y0 = y;
+    commands.setLayer(DrawLayer::HUD);
+    const SDL_Color yellow = {255, 220, 0, 255};
+    const SDL_Color phases[3] = {{80, 220, 80, 255}, {80, 200, 255, 255}, {255, 100, 255, 255}};
+    const SDL_Color white = {255, 255, 255, 255};
+    const SDL_Color orange = {255, 150, 50, 255};
+    const SDL_Color red = {255, 80, 80, 255};
+
+    y += recordGraph(commands, text, x, y, "frame", " ms", FRAME_MS, FRAME_MS, &yellow);
+    y += recordGraph(commands, text, x, y, "step", " ms", INTEGRATE_MS, SOLVE_MS, phases);
+    y += recordGraph(commands, text, x, y, "steps/s", "", STEPS_PER_SECOND, STEPS_PER_SECOND, &white);
+    y += recordGraph(commands, text, x, y, "objects", "", OBJECTS, OBJECTS, &white);
+    y += recordGraph(commands, text, x, y, "contacts", "", CONTACTS, CONTACTS, &orange);
+    recordGraph(commands, text, x, y, "mutex wait", " ms/step", MUTEX_WAIT_MS, MUTEX_WAIT_MS, &red);
+    // Below the line of text in the top-left corner.
+    if (hasLocks)
+        recordLocks(commands, text, x - WIDTH - PANEL_GAP, y0 + text.lineHeight());
+}
+
+float PerfHud::recordGraph(CommandBuffer& commands, const TextRenderer& text, float x, float y, const char* label,
+                           const char* unit, Series first, Series last, const SDL_Color* colors) const {
+    const float height = text.lineHeight() + GRAPH_HEIGHT + 2.0f * PANEL_GAP;
+    const SDL_Rect panel = {static_cast<int>(x), static_cast<int>(y), static_cast<int>(WIDTH),
+                            static_cast<int>(height)};
+    commands.fillRect(panel, {0, 0, 0, 160}, SDL_BLENDMODE_BLEND);
+
+    // Scale to the largest value shown, so the graph always uses its full height.
+    float peak = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+        peak = std::max(peak, stacked(first, last, i));
+    const float current = count > 0 ? stacked(first, last, count - 1) : 0.0f;
+
+    char line[64];
+    const char* format = peak >= 100.0f ? "%s %.0f%s  max %.0f" : "%s %.2f%s  max %.2f";
+    std::snprintf(line, sizeof(line), format, label, current, unit, peak);
+    commands.text(line, x + PANEL_GAP, y + PANEL_GAP, colors[last - first]);
+
+    if (count < 2)
+        return height + PANEL_GAP;
+    const float bottom = y + height - PANEL_GAP;
+    const float scale = peak > 0.0f ? GRAPH_HEIGHT / peak : 0.0f;
+    const float dx = (WIDTH - 2.0f * PANEL_GAP) / (HISTORY - 1);
+    const float left = x + PANEL_GAP + (HISTORY - count) * dx;
+    // One polyline per stacked series; the top one is the total.
+    for (int s = first; s <= last; ++s) {
+        float previous = bottom - stacked(first, static_cast<Series>(s), 0) * scale;
+        for (size_t i = 1; i < count; ++i) {
+            const float value = bottom - stacked(first, static_cast<Series>(s), i) * scale;
+            commands.line(left + (i - 1) * dx, previous, left + i * dx, value, colors[s - first]);
+            previous = value;
+        }
+    }
+    return height + PANEL_GAP;
+}
+
+float PerfHud::recordLocks(CommandBuffer& commands, const TextRenderer& text, float x, float y) const {
+    const SDL_Color white = {255, 255, 255, 255};
+    const SDL_Color waitColor = {255, 80, 80, 255};
+    const SDL_Color holdColor = {80, 220, 80, 255};
+    const float lineHeight = static_cast<float>(text.lineHeight());
+    const float siteHeight = lineHeight + LOCK_BAR_HEIGHT + PANEL_GAP;
+    const float height = lineHeight + LOCK_SITES * siteHeight + 2.0f * PANEL_GAP;
+    const SDL_Rect panel = {static_cast<int>(x), static_cast<int>(y), static_cast<int>(WIDTH),
+                            static_cast<int>(height)};
+    commands.fillRect(panel, {0, 0, 0, 160}, SDL_BLENDMODE_BLEND);
+    commands.text("locks/s, p99 wait | hold", x + PANEL_GAP, y + PANEL_GAP, white);
+
+    // Wait histogram on the left half, hold histogram on the right half.
+    const float half = (WIDTH - 3.0f * PANEL_GAP) / 2.0f;
+    const float barStep = half / LockStats::BUCKETS;
+    float top = y + PANEL_GAP + lineHeight;
+    for (size_t s = 0; s < LOCK_SITES; ++s) {
+        const LockStats::Counts& counts = lockWindow[s];
+        char wait[16], hold[16], line[64];
+        formatPercentile(wait, sizeof(wait), counts.wait, counts.locks);
+        formatPercentile(hold, sizeof(hold), counts.hold, counts.locks);
+        const float perSecond = lockWindowMs > 0.0f ? counts.locks * 1000.0f / lockWindowMs : 0.0f;
+        std::snprintf(line, sizeof(line), "%s %.0f, %s | %s", lockSiteName(static_cast<LockSite>(s)), perSecond,
+                      wait, hold);
+        commands.text(line, x + PANEL_GAP, top, white);
+
+        const float bottom = top + lineHeight + LOCK_BAR_HEIGHT;
+        for (int side = 0; side < 2; ++side) {
+            const uint64_t* buckets = side == 0 ? counts.wait : counts.hold;
+            const float left = x + PANEL_GAP + side * (half + PANEL_GAP);
+            // Each histogram is scaled to its fullest bucket; any lock shows as at least a pixel.
+            const uint64_t peak = *std::max_element(buckets, buckets + LockStats::BUCKETS);
+            for (size_t i = 0; i < LockStats::BUCKETS && peak > 0; ++i) {
+                if (buckets[i] == 0)
+                    continue;
+                const int barHeight = std::max(1, static_cast<int>(LOCK_BAR_HEIGHT * buckets[i] / peak));
+                const SDL_Rect bar = {static_cast<int>(left + i * barStep), static_cast<int>(bottom) - barHeight,
+                                      std::max(1, static_cast<int>(barStep) - 2), barHeight};
+                commands.fillRect(bar, side == 0 ? waitColor : holdColor);
+            }
+        }
+        top += siteHeight;
+    }
+    return height + PANEL_GAP;
+}
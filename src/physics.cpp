@@ -1,47 +1,157 @@
 #include "physics.hpp"
 #include "object.hpp"
+#include "ball.hpp"
 #include "collision.hpp"
+#include "contact_solver.hpp"
+#include "thread_pool.hpp"
+#include "xpbd.hpp"
 #include <chrono>
 #include <thread>
 #include <mutex>
 #include <vector>
+#include <algorithm>
 
 constexpr float TIME_STEP = 0.001f;
+constexpr float XPBD_TIME_STEP = 1.0f / 60.0f;
+// Minimum time between two published snapshots, in seconds.
+constexpr float SNAPSHOT_INTERVAL = 1.0f / 240.0f;
+// Simulated time allowed to pile up when the physics thread falls behind, in seconds.
+constexpr float MAX_ACCUMULATED_TIME = 0.25f;
 
-void physicsThreadFunction(bool &running, std::vector<Object*> &objects, std::mutex &objectsMutex) {
+// Objects per task when integrating.
+constexpr size_t INTEGRATE_GRAIN = 256;
+
+PhysicsStepper::PhysicsStepper(unsigned threads)
+    : pool(threads), steps(0)
+{}
+
+float PhysicsStepper::stepSize(SolverMode mode) {
+    return mode == SolverMode::XPBD ? XPBD_TIME_STEP : TIME_STEP;
+}
+
+void PhysicsStepper::step(std::vector<Object*> &objects, SolverMode mode, const WorldBounds &bounds,
+                          const WorldParams &params) {
+    if (mode == SolverMode::XPBD) {
+        xpbd.step(objects, XPBD_TIME_STEP, bounds, params, pool);
+        times = xpbd.lastTimes();
+        contacts = xpbd.contactCount();
+    } else {
+        const double start = phaseClock();
+        // Update physics for each object. Only dynamic objects (Ball) perform updates.
+        pool.parallelFor(objects.size(), INTEGRATE_GRAIN, [&](size_t begin, size_t end) {
+            stepBalls(objects, begin, end, TIME_STEP, bounds, params);
+        });
+        const double integrated = phaseClock();
+        // Resolve collisions colour by colour.
+        solver.prepare(objects, pool);
+        const double detected = phaseClock();
+        solver.resolve(objects, params, pool);
+        times.integrate = integrated - start;
+        times.detect = detected - integrated;
+        times.solve = phaseClock() - detected;
+        contacts = solver.contacts().size();
+    }
+    steps++;
+}
+
+// FNV-1a over the raw bytes of the state.
+uint64_t hashObjects(const std::vector<Object*> &objects) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const Object* obj : objects) {
+        const float state[4] = {obj->x, obj->y, obj->vx, obj->vy};
+        const unsigned char type = static_cast<unsigned char>(obj->type);
+        mix(&type, sizeof(type));
+        mix(state, sizeof(state));
+    }
+    return hash;
+}
+
+// Sums over the steps since the last snapshot.
+struct StepTotals {
+    StepTimes times;
+    double mutexWait = 0.0;
+    uint32_t steps = 0;
+    uint32_t contacts = 0;
+};
+
+// Copy the objects and the statistics of the steps since the last snapshot
+// into a fresh snapshot and hand it to readers.
+static void publishSnapshot(World &world, SnapshotBuffer &snapshots, const StepTotals &totals, float elapsed,
+                            ThreadPool &pool) {
+    std::shared_ptr<WorldSnapshot> snapshot = snapshots.acquire();
+    {
+        TimedLock lock(world.mutex, world.locks, LockSite::SNAPSHOT);
+        snapshot->capture(world.objects);
+    }
+    // Outside the lock; the render thread only queries the finished index.
+    snapshot->buildIndex(&pool);
+    PhysicsStats& stats = snapshot->stats;
+    const double perStep = totals.steps > 0 ? 1000.0 / totals.steps : 0.0;
+    stats.integrateMs = static_cast<float>(totals.times.integrate * perStep);
+    stats.detectMs = static_cast<float>(totals.times.detect * perStep);
+    stats.solveMs = static_cast<float>(totals.times.solve * perStep);
+    stats.mutexWaitMs = static_cast<float>(totals.mutexWait * perStep);
+    stats.stepsPerSecond = elapsed > 0.0f ? totals.steps / elapsed : 0.0f;
+    stats.objects = static_cast<uint32_t>(snapshot->objects.size());
+    stats.contacts = totals.contacts;
+    snapshots.publish(snapshot);
+}
+
+void physicsThreadFunction(bool &running, World &world, PhysicsSettings &settings, SnapshotBuffer &snapshots) {
+    PhysicsStepper stepper(settings.threads);
+    Metrics* const metrics = settings.metrics;
     auto previous = std::chrono::high_resolution_clock::now();
+    auto lastSnapshot = previous;
+    float accumulator = 0.0f;
+    StepTotals totals;
     while (running) {
         auto current = std::chrono::high_resolution_clock::now();
         std::chrono::duration<float> elapsed = current - previous;
         previous = current;
-        float accumulator = elapsed.count();
-        while (accumulator >= TIME_STEP) {
-            {
-                std::lock_guard<std::mutex> lock(objectsMutex);
-                // Update physics for each object. Only dynamic objects (Ball) perform updates.
-                for (auto obj : objects) {
-                    obj->updatePhysics(TIME_STEP);
-                }
-                // Resolve collisions in a pairwise manner.
-                for (size_t i = 0; i < objects.size(); ++i) {
-                    for (size_t j = i + 1; j < objects.size(); ++j) {
-                        resolveCollision(objects[i], objects[j]);
-                    }
-                }
-            }
-            accumulator -= TIME_STEP;
+        accumulator = std::min(accumulator + elapsed.count(), MAX_ACCUMULATED_TIME);
+
+        const float sinceSnapshot = std::chrono::duration<float>(current - lastSnapshot).count();
+        if (sinceSnapshot >= SNAPSHOT_INTERVAL) {
+            publishSnapshot(world, snapshots, totals, sinceSnapshot, stepper.threadPool());
+            lastSnapshot = current;
+            const uint32_t contacts = totals.contacts;
+            totals = StepTotals();
+            totals.contacts = contacts;
         }
-        if (accumulator > 0.0f) {
-            std::lock_guard<std::mutex> lock(objectsMutex);
-            for (auto obj : objects) {
-                obj->updatePhysics(accumulator);
+
+        // Only whole steps are taken; the rest carries over to the next round, so
+        // the sequence of steps does not depend on how the thread is scheduled.
+        SolverMode mode = settings.solverMode.load();
+        float stepSize = PhysicsStepper::stepSize(mode);
+        while (accumulator >= stepSize) {
+            double wait;
+            {
+                TimedLock lock(world.mutex, world.locks, LockSite::STEP);
+                wait = lock.waited();
+                stepper.step(world.objects, mode, world.bounds, world.params);
+                world.updateLifetimes(stepSize);
             }
-            for (size_t i = 0; i < objects.size(); ++i) {
-                for (size_t j = i + 1; j < objects.size(); ++j) {
-                    resolveCollision(objects[i], objects[j]);
-                }
+            const StepTimes& times = stepper.lastTimes();
+            if (metrics) {
+                metrics->stepDuration.observe(times.total());
+                metrics->mutexWaitNanos.fetch_add(static_cast<uint64_t>(wait * 1e9), std::memory_order_relaxed);
+                metrics->contacts.store(static_cast<uint32_t>(stepper.contactCount()), std::memory_order_relaxed);
             }
+            totals.mutexWait += wait;
+            totals.times.integrate += times.integrate;
+            totals.times.detect += times.detect;
+            totals.times.solve += times.solve;
+            totals.steps++;
+            totals.contacts = static_cast<uint32_t>(stepper.contactCount());
+            accumulator -= stepSize;
         }
         std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
-}
\ No newline at end of file
+}
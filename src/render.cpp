@@ -1,61 +1,51 @@
 #include "render.hpp"
-#include "object.hpp"
-#include <sstream>
-#include <iomanip>
+#include <cstdio>
 
-void renderObject(SDL_Renderer* renderer, const Object* obj) {
-    if (obj)
-        obj->render(renderer);
+SDL_Rect boundingBox(const Camera& camera, const ObjectState& obj) {
+    SDL_Rect rect;
+    rect.w = static_cast<int>(obj.width * camera.zoom);
+    rect.h = static_cast<int>(obj.height * camera.zoom);
+    rect.x = static_cast<int>(camera.toScreenX(obj.x - obj.width * 0.5f));
+    rect.y = static_cast<int>(camera.toScreenY(obj.y - obj.height * 0.5f));
+    return rect;
 }
 
-void renderDebugInfo(SDL_Renderer* renderer, TTF_Font* font, const Object* obj) {
-    if (!obj || !font) return;
-
-    // Draw collision box in red
-    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-    
-    // Get object's bounding box
-    SDL_Rect boundingBox = obj->getBoundingBox();
-    SDL_RenderDrawRect(renderer, &boundingBox);
-    
-    // Format debug text with position and velocity
-    std::stringstream debugText;
-    debugText << std::fixed << std::setprecision(1);
-    debugText << "Pos:(" << obj->x << "," << obj->y << ")";
-    debugText << " Vel:(" << obj->vx << "," << obj->vy << ")";
-    
-    // Add type-specific information
-    if (obj->type == ObjectType::BALL) {
-        debugText << " Type:Ball";
+void recordObject(CommandBuffer& commands, const Camera& camera, const ObjectState& obj, CircleStyle ballStyle) {
+    if (obj.type == ObjectType::BALL) {
+        SDL_Color ballColor = {255, 255, 255, 255};
+        commands.circle(camera.toScreenX(obj.x), camera.toScreenY(obj.y), obj.radius * camera.zoom,
+                        ballColor, ballStyle);
     } else {
-        debugText << " Type:Box";
+        SDL_Color boxColor = {180, 180, 180, 255};
+        commands.fillRect(boundingBox(camera, obj), boxColor);
     }
-    
-    // Render text with shadow for better visibility
+}
+
+void recordVelocityInfo(CommandBuffer& commands, const TextRenderer& text, const Camera& camera, const ObjectState& obj) {
+    char label[64];
+    std::snprintf(label, sizeof(label), "v: (%d, %d)", static_cast<int>(obj.vx), static_cast<int>(obj.vy));
+    int width, height;
+    text.measure(label, width, height);
+    SDL_Color white = {255, 255, 255, 255};
+    commands.text(label, camera.toScreenX(obj.x) - width / 2,
+                  camera.toScreenY(obj.y - obj.radius) - height - 2, white);
+}
+
+void recordDebugInfo(CommandBuffer& commands, const TextRenderer& text, const Camera& camera, const ObjectState& obj) {
+    // Draw collision box in red
+    SDL_Rect box = boundingBox(camera, obj);
+    SDL_Color red = {255, 0, 0, 255};
+    commands.rect(box, red);
+
+    // Format debug text with position, velocity and type
+    char debugText[128];
+    std::snprintf(debugText, sizeof(debugText), "Pos:(%.1f,%.1f) Vel:(%.1f,%.1f) Type:%s",
+                  obj.x, obj.y, obj.vx, obj.vy,
+                  obj.type == ObjectType::BALL ? "Ball" : "Box");
+
+    // Text above the object, with a shadow for better visibility
     SDL_Color textColor = {255, 255, 0, 255}; // Yellow is more visible
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, debugText.str().c_str(), textColor);
-    if (textSurface) {
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        if (textTexture) {
-            // Position text above the object
-            SDL_Rect textRect = {
-                boundingBox.x,
-                boundingBox.y - textSurface->h - 5,
-                textSurface->w,
-                textSurface->h
-            };
-            
-            // Draw shadow first
-            SDL_SetTextureColorMod(textTexture, 0, 0, 0);
-            SDL_Rect shadowRect = {textRect.x + 1, textRect.y + 1, textRect.w, textRect.h};
-            SDL_RenderCopy(renderer, textTexture, nullptr, &shadowRect);
-            
-            // Then draw text
-            SDL_SetTextureColorMod(textTexture, 255, 255, 0);
-            SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-            
-            SDL_DestroyTexture(textTexture);
-        }
-        SDL_FreeSurface(textSurface);
-    }
-}
\ No newline at end of file
+    SDL_Color shadowColor = {0, 0, 0, 255};
+    commands.shadowedText(debugText, static_cast<float>(box.x),
+                          static_cast<float>(box.y - text.lineHeight() - 5), textColor, shadowColor);
+}
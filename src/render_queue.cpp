@@ -0,0 +1,173 @@
+#include "render_queue.hpp"
+#include <SDL2/SDL2_gfxPrimitives.h>
+#include <algorithm>
+
+// Groups inside a layer, in drawing order.
+constexpr uint64_t GROUP_FLAT = 0;
+constexpr uint64_t GROUP_CIRCLES = 1;
+constexpr uint64_t GROUP_TEXT = 2;
+
+static uint64_t groupOf(DrawOp op) {
+    if (op == DrawOp::CIRCLE)
+        return GROUP_CIRCLES;
+    if (op == DrawOp::TEXT)
+        return GROUP_TEXT;
+    return GROUP_FLAT;
+}
+
+static uint32_t packColor(SDL_Color c) {
+    return (uint32_t(c.r) << 24) | (uint32_t(c.g) << 16) | (uint32_t(c.b) << 8) | uint32_t(c.a);
+}
+
+// Layer | group | blend | colour | op, most significant first. Circles and
+// text only use layer and group: each group is one batch whatever the colour.
+static uint64_t sortKey(const DrawCommand& c) {
+    const uint64_t group = groupOf(c.op);
+    uint64_t key = (uint64_t(c.layer) << 56) | (group << 48);
+    if (group == GROUP_FLAT)
+        key |= (uint64_t(c.blend & 0xff) << 40) | (uint64_t(packColor(c.color)) << 8) | uint64_t(c.op);
+    return key;
+}
+
+bool RenderQueue::init(SDL_Renderer* renderer, const BitmapFont& font) {
+    return textBatch.init(renderer, font);
+}
+
+void RenderQueue::releaseTextures() {
+    sprites.releaseTexture();
+    textBatch.releaseTexture();
+}
+
+void RenderQueue::setState(SDL_Renderer* renderer, SDL_BlendMode blend, SDL_Color color) {
+    if (!stateValid || blend != currentBlend)
+        SDL_SetRenderDrawBlendMode(renderer, blend);
+    if (!stateValid || packColor(color) != packColor(currentColor))
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+    stateValid = true;
+    currentBlend = blend;
+    currentColor = color;
+}
+
+void RenderQueue::execute(SDL_Renderer* renderer, const CommandBuffer& commands, bool spriteCircles, ThreadPool* pool) {
+    const std::vector<DrawCommand>& list = commands.commands();
+    order.resize(list.size());
+    for (size_t i = 0; i < list.size(); ++i) {
+        order[i].key = sortKey(list[i]);
+        order[i].index = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(), [](const Item& l, const Item& r) {
+        return l.key != r.key ? l.key < r.key : l.index < r.index;
+    });
+
+    // The renderer may have been changed since the last frame.
+    stateValid = false;
+    sprites.clear();
+    outlineMeshes.clear();
+    filledMeshes.clear();
+
+    size_t i = 0;
+    while (i < order.size()) {
+        const DrawCommand& first = list[order[i].index];
+        size_t end = i + 1;
+        while (end < order.size() && order[end].key == order[i].key)
+            ++end;
+
+        switch (groupOf(first.op)) {
+            case GROUP_FLAT:
+                setState(renderer, first.blend, first.color);
+                drawRun(renderer, list, i, end);
+                break;
+            case GROUP_CIRCLES:
+                for (size_t k = i; k < end; ++k) {
+                    const DrawCommand& c = list[order[k].index];
+                    // Zoomed in circles would need huge sprites; meshes stay sharp.
+                    if (spriteCircles && c.a <= CircleAtlas::MAX_SPRITE_RADIUS)
+                        sprites.add(c.x, c.y, c.a, c.color, c.style);
+                    else if (c.style == CircleStyle::FILLED)
+                        filledMeshes.add(c.x, c.y, c.a, c.color);
+                    else
+                        outlineMeshes.add(c.x, c.y, c.a, c.color);
+                }
+                flushGeometry(renderer, pool);
+                break;
+            case GROUP_TEXT:
+                for (size_t k = i; k < end; ++k) {
+                    const DrawCommand& c = list[order[k].index];
+                    textBatch.add(commands.textOf(c), c.x, c.y, c.color);
+                }
+                flushGeometry(renderer, pool);
+                break;
+        }
+        i = end;
+    }
+}
+
+// Every command in [begin, end) has the same op, blend mode and colour.
+void RenderQueue::drawRun(SDL_Renderer* renderer, const std::vector<DrawCommand>& list, size_t begin, size_t end) {
+    const DrawOp op = list[order[begin].index].op;
+    points.clear();
+    rects.clear();
+    switch (op) {
+        case DrawOp::POINT:
+            for (size_t k = begin; k < end; ++k) {
+                const DrawCommand& c = list[order[k].index];
+                points.push_back({static_cast<int>(c.x), static_cast<int>(c.y)});
+            }
+            SDL_RenderDrawPoints(renderer, points.data(), static_cast<int>(points.size()));
+            break;
+        case DrawOp::LINE:
+            // Segments that continue where the previous one ended share one polyline.
+            for (size_t k = begin; k < end; ++k) {
+                const DrawCommand& c = list[order[k].index];
+                const SDL_Point from = {static_cast<int>(c.x), static_cast<int>(c.y)};
+                const SDL_Point to = {static_cast<int>(c.a), static_cast<int>(c.b)};
+                if (points.empty() || points.back().x != from.x || points.back().y != from.y) {
+                    if (points.size() > 1)
+                        SDL_RenderDrawLines(renderer, points.data(), static_cast<int>(points.size()));
+                    points.clear();
+                    points.push_back(from);
+                }
+                points.push_back(to);
+            }
+            SDL_RenderDrawLines(renderer, points.data(), static_cast<int>(points.size()));
+            break;
+        case DrawOp::AA_LINE:
+            for (size_t k = begin; k < end; ++k) {
+                const DrawCommand& c = list[order[k].index];
+                aalineRGBA(renderer, static_cast<Sint16>(c.x), static_cast<Sint16>(c.y),
+                           static_cast<Sint16>(c.a), static_cast<Sint16>(c.b),
+                           c.color.r, c.color.g, c.color.b, c.color.a);
+            }
+            // SDL2_gfx sets its own colour and blend mode.
+            stateValid = false;
+            break;
+        case DrawOp::RECT:
+        case DrawOp::FILL_RECT:
+            for (size_t k = begin; k < end; ++k) {
+                const DrawCommand& c = list[order[k].index];
+                rects.push_back({static_cast<int>(c.x), static_cast<int>(c.y),
+                                 static_cast<int>(c.a), static_cast<int>(c.b)});
+            }
+            if (op == DrawOp::RECT)
+                SDL_RenderDrawRects(renderer, rects.data(), static_cast<int>(rects.size()));
+            else
+                SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+            break;
+        case DrawOp::CIRCLE:
+        case DrawOp::TEXT:
+            break;
+    }
+}
+
+void RenderQueue::flushGeometry(SDL_Renderer* renderer, ThreadPool* pool) {
+    // Untextured geometry uses the draw blend mode; the meshes are opaque.
+    SDL_Color white = {255, 255, 255, 255};
+    setState(renderer, SDL_BLENDMODE_NONE, stateValid ? currentColor : white);
+    sprites.draw(renderer, pool);
+    outlineMeshes.draw(renderer, CircleStyle::OUTLINE, pool);
+    filledMeshes.draw(renderer, CircleStyle::FILLED, pool);
+    textBatch.draw(renderer);
+    sprites.clear();
+    outlineMeshes.clear();
+    filledMeshes.clear();
+}
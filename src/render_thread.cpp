@@ -0,0 +1,98 @@
+#include "render_thread.hpp"
+#include <iostream>
+#include <cstdio>
+
+// How often the HUD's frame statistics are refreshed, in milliseconds.
+constexpr Uint32 STATS_INTERVAL = 1000;
+
+RenderThread::RenderThread(SDL_Window* window, const WorldBounds& bounds, SnapshotBuffer& snapshots,
+                           PacingMode pacing, double targetFps, Metrics* metrics, const LockStats* locks)
+    : window(window), snapshots(snapshots), metrics(metrics), locks(locks), scene(bounds), pacer(pacing, targetFps)
+{}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+bool RenderThread::start() {
+    if (running)
+        return true;
+    std::promise<bool> started;
+    std::future<bool> result = started.get_future();
+    running = true;
+    thread = std::thread(&RenderThread::run, this, &started);
+    if (result.get())
+        return true;
+    thread.join();
+    running = false;
+    return false;
+}
+
+void RenderThread::stop() {
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+void RenderThread::setView(const ViewState& state) {
+    std::lock_guard<std::mutex> lock(viewMutex);
+    view = state;
+}
+
+bool RenderThread::init() {
+    renderer = SDL_CreateRenderer(window, -1, pacer.rendererFlags());
+    if (!renderer) {
+        std::cerr << "SDL_CreateRenderer Error: " << SDL_GetError() << "\n";
+        return false;
+    }
+    SDL_DisplayMode display;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &display) == 0)
+        pacer.setRefreshRate(display.refresh_rate);
+    return scene.init(renderer);
+}
+
+void RenderThread::shutdown() {
+    scene.releaseTextures();
+    if (renderer)
+        SDL_DestroyRenderer(renderer);
+    renderer = nullptr;
+}
+
+void RenderThread::run(std::promise<bool>* started) {
+    if (!init()) {
+        shutdown();
+        started->set_value(false);
+        return;
+    }
+    started->set_value(true);
+
+    statsTimer = SDL_GetTicks();
+    while (running) {
+        ViewState state;
+        {
+            std::lock_guard<std::mutex> lock(viewMutex);
+            state = view;
+        }
+        std::shared_ptr<const WorldSnapshot> snapshot = snapshots.latest();
+
+        char hudText[96];
+        std::snprintf(hudText, sizeof(hudText), "FPS: %d  frame p50 %.1f  p99 %.1f  max %.1f ms%s",
+                      static_cast<int>(stats.fps + 0.5f), stats.p50, stats.p99, stats.max,
+                      state.xpbd ? " (XPBD)" : "");
+        scene.draw(renderer, snapshot.get(), state, hudText, &pool, &perfHud);
+        // Keep sampling while the graphs are hidden, so they show history when opened.
+        perfHud.addSample(pacer.lastFrameMs(), snapshot ? snapshot->stats : PhysicsStats(), locks);
+        snapshot.reset();
+        SDL_RenderPresent(renderer);
+        pacer.endFrame();
+        if (metrics && pacer.lastFrameMs() > 0.0f)
+            metrics->frameDuration.observe(pacer.lastFrameMs() / 1000.0);
+
+        Uint32 currentTicks = SDL_GetTicks();
+        if (currentTicks - statsTimer >= STATS_INTERVAL) {
+            stats = pacer.takeStats();
+            statsTimer = currentTicks;
+        }
+    }
+    shutdown();
+}
@@ -0,0 +1,213 @@
+#include "scene_file.hpp"
+#include "ball.hpp"
+#include "box.hpp"
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Alignment of the record arrays.
+constexpr uint64_t SECTION_ALIGN = 64;
+
+constexpr uint32_t SceneHeader::MAGIC;
+constexpr uint32_t SceneHeader::VERSION;
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+}
+
+// Records with NaN or infinite values or a size that is not positive would
+// poison the solvers and the spatial index.
+static bool isValid(const SceneBall& ball) {
+    return std::isfinite(ball.x) && std::isfinite(ball.y) && std::isfinite(ball.vx) && std::isfinite(ball.vy) &&
+           std::isfinite(ball.radius) && ball.radius > 0.0f;
+}
+
+static bool isValid(const SceneBox& box) {
+    return std::isfinite(box.x) && std::isfinite(box.y) && std::isfinite(box.width) && std::isfinite(box.height) &&
+           box.width > 0.0f && box.height > 0.0f;
+}
+
+// Spawn a record; false if it is invalid and was skipped.
+static bool spawn(World& world, const SceneBall& ball) {
+    if (!isValid(ball))
+        return false;
+    world.spawnBall(ball.x, ball.y, ball.vx, ball.vy, ball.radius);
+    return true;
+}
+
+static bool spawn(World& world, const SceneBox& box) {
+    if (!isValid(box))
+        return false;
+    world.spawnBox(box.x, box.y, box.width, box.height);
+    return true;
+}
+
+// True if the balls-before counts of the boxes never decrease and stay
+// within the balls, so merging the two arrays visits every record once.
+static bool orderValid(const uint64_t* boxOrder, uint64_t boxCount, uint64_t ballCount) {
+    uint64_t previous = 0;
+    for (uint64_t i = 0; i < boxCount; ++i) {
+        if (boxOrder[i] < previous || boxOrder[i] > ballCount)
+            return false;
+        previous = boxOrder[i];
+    }
+    return true;
+}
+
+// True if count records of recordSize at offset lie inside the file.
+static bool sectionFits(uint64_t offset, uint64_t count, uint64_t recordSize, uint64_t fileSize) {
+    return offset % SECTION_ALIGN == 0 && offset <= fileSize && count <= (fileSize - offset) / recordSize;
+}
+
+SceneFile::~SceneFile() {
+    close();
+}
+
+void SceneFile::close() {
+    if (data)
+        munmap(data, size);
+    data = nullptr;
+    size = 0;
+}
+
+bool SceneFile::open(const std::string& path, std::string& error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SceneHeader)) {
+        ::close(fd);
+        error = path + " is not a scene file";
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        error = "cannot map " + path;
+        return false;
+    }
+
+    // A big-endian host reads the magic byte-swapped and rejects the file.
+    const SceneHeader& h = header();
+    if (h.magic != SceneHeader::MAGIC) {
+        error = path + " is not a scene file";
+    } else if (h.version != SceneHeader::VERSION) {
+        error = path + " has unsupported scene version " + std::to_string(h.version);
+    } else if (!(h.worldWidth > 0.0f && h.worldHeight > 0.0f && std::isfinite(h.worldWidth) &&
+                 std::isfinite(h.worldHeight))) {
+        error = path + " has an invalid world size";
+    } else if (!sectionFits(h.ballOffset, h.ballCount, sizeof(SceneBall), size) ||
+               !sectionFits(h.boxOffset, h.boxCount, sizeof(SceneBox), size) ||
+               !sectionFits(h.boxOrderOffset, h.boxCount, sizeof(uint64_t), size)) {
+        error = path + " is truncated";
+    } else if (!orderValid(boxOrder(), h.boxCount, h.ballCount)) {
+        error = path + " has an invalid object order";
+    } else {
+        // Objects are read front to back once.
+        madvise(data, size, MADV_SEQUENTIAL);
+        return true;
+    }
+    close();
+    return false;
+}
+
+const SceneBall* SceneFile::balls() const {
+    return reinterpret_cast<const SceneBall*>(static_cast<const uint8_t*>(data) + header().ballOffset);
+}
+
+const SceneBox* SceneFile::boxes() const {
+    return reinterpret_cast<const SceneBox*>(static_cast<const uint8_t*>(data) + header().boxOffset);
+}
+
+const uint64_t* SceneFile::boxOrder() const {
+    return reinterpret_cast<const uint64_t*>(static_cast<const uint8_t*>(data) + header().boxOrderOffset);
+}
+
+bool writeScene(const std::string& path, const WorldBounds& bounds, const std::vector<SceneBall>& balls,
+                const std::vector<SceneBox>& boxes, const std::vector<uint64_t>& boxOrder) {
+    SceneHeader header;
+    header.magic = SceneHeader::MAGIC;
+    header.version = SceneHeader::VERSION;
+    header.worldWidth = bounds.width;
+    header.worldHeight = bounds.height;
+    header.ballCount = balls.size();
+    header.ballOffset = alignUp(sizeof(SceneHeader));
+    header.boxCount = boxes.size();
+    header.boxOffset = alignUp(header.ballOffset + balls.size() * sizeof(SceneBall));
+    header.boxOrderOffset = alignUp(header.boxOffset + boxes.size() * sizeof(SceneBox));
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const uint8_t padding[SECTION_ALIGN] = {};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(padding, 1, header.ballOffset - sizeof(header), file) == header.ballOffset - sizeof(header);
+    ok = ok && std::fwrite(balls.data(), sizeof(SceneBall), balls.size(), file) == balls.size();
+    const uint64_t ballEnd = header.ballOffset + balls.size() * sizeof(SceneBall);
+    ok = ok && std::fwrite(padding, 1, header.boxOffset - ballEnd, file) == header.boxOffset - ballEnd;
+    ok = ok && std::fwrite(boxes.data(), sizeof(SceneBox), boxes.size(), file) == boxes.size();
+    const uint64_t boxEnd = header.boxOffset + boxes.size() * sizeof(SceneBox);
+    ok = ok && std::fwrite(padding, 1, header.boxOrderOffset - boxEnd, file) == header.boxOrderOffset - boxEnd;
+    ok = ok && std::fwrite(boxOrder.data(), sizeof(uint64_t), boxOrder.size(), file) == boxOrder.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+bool saveScene(const std::string& path, const World& world) {
+    std::vector<SceneBall> balls;
+    std::vector<SceneBox> boxes;
+    std::vector<uint64_t> boxOrder;
+    balls.reserve(world.ballCount());
+    for (const Object* obj : world.objects) {
+        if (obj->type == ObjectType::BALL) {
+            const Ball* ball = static_cast<const Ball*>(obj);
+            balls.push_back({ball->x, ball->y, ball->vx, ball->vy, ball->radius});
+        } else {
+            const Box* box = static_cast<const Box*>(obj);
+            boxes.push_back({box->x, box->y, box->width, box->height});
+            boxOrder.push_back(balls.size());
+        }
+    }
+    return writeScene(path, world.bounds, balls, boxes, boxOrder);
+}
+
+bool loadScene(const std::string& path, World& world, std::string& error) {
+    SceneFile file;
+    if (!file.open(path, error))
+        return false;
+    const SceneHeader& header = file.header();
+
+    world.clear();
+    world.bounds.width = header.worldWidth;
+    world.bounds.height = header.worldHeight;
+    const size_t skipped =
+        spawnSceneObjects(world, file.balls(), header.ballCount, file.boxes(), header.boxCount, file.boxOrder());
+    if (skipped > 0)
+        std::cerr << "Skipped " << skipped << " invalid objects in " << path << "\n";
+    return true;
+}
+
+size_t spawnSceneObjects(World& world, const SceneBall* balls, size_t ballCount, const SceneBox* boxes,
+                         size_t boxCount, const uint64_t* boxOrder) {
+    world.reserve(world.objects.size() + boxCount + ballCount);
+    // Records are checked here rather than when opening, as this loop reads
+    // every one anyway.
+    size_t skipped = 0;
+    size_t ball = 0;
+    for (size_t box = 0; box < boxCount; ++box) {
+        for (const size_t before = boxOrder ? boxOrder[box] : 0; ball < before; ++ball)
+            skipped += spawn(world, balls[ball]) ? 0 : 1;
+        skipped += spawn(world, boxes[box]) ? 0 : 1;
+    }
+    for (; ball < ballCount; ++ball)
+        skipped += spawn(world, balls[ball]) ? 0 : 1;
+    return skipped;
+}
@@ -0,0 +1,220 @@
+#include "scene_generator.hpp"
+#include <cmath>
+#include <algorithm>
+
+// Largest ball radius of a generated scene.
+constexpr float MAX_RADIUS = 10.0f;
+// Packed balls are spaced this much wider than touching, so they start apart.
+constexpr float GAP = 1.01f;
+// Balls generated per task.
+constexpr size_t GENERATE_GRAIN = 4096;
+// Balls per pyramid is about PYRAMID_SIZE times the number of pyramids.
+constexpr float PYRAMID_SIZE = 100.0f;
+constexpr float SQRT3 = 1.7320508f;
+constexpr float PI = 3.14159265f;
+
+// Counter-based random numbers: number k of ball i depends only on the seed,
+// i and k, never on which thread made the ball or in which order.
+static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static float random01(uint32_t seed, uint64_t i, uint32_t k) {
+    const uint64_t h = mix((static_cast<uint64_t>(seed) << 32 | k) ^ mix(i + 0x9e3779b97f4a7c15ull));
+    return (h >> 40) / 16777216.0f;
+}
+
+// count cells of equal size covering a rectangle, row by row.
+struct CellGrid {
+    float x, y;
+    float cellWidth, cellHeight;
+    size_t columns;
+
+    CellGrid(float x, float y, float width, float height, size_t count) : x(x), y(y) {
+        count = std::max<size_t>(count, 1);
+        columns = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(count * width / height))));
+        const size_t rows = (count + columns - 1) / columns;
+        cellWidth = width / columns;
+        cellHeight = height / rows;
+    }
+
+    float cellSize() const { return std::min(cellWidth, cellHeight); }
+
+    // A point inside cell i, at least margin away from its edges.
+    void place(size_t i, float margin, float jitterX, float jitterY, float& px, float& py) const {
+        const float slackX = std::max(0.0f, cellWidth * 0.5f - margin);
+        const float slackY = std::max(0.0f, cellHeight * 0.5f - margin);
+        px = x + ((i % columns) + 0.5f) * cellWidth + (jitterX * 2.0f - 1.0f) * slackX;
+        py = y + ((i / columns) + 0.5f) * cellHeight + (jitterY * 2.0f - 1.0f) * slackY;
+    }
+};
+
+// Every ball in its own cell of the upper half, falling at random speeds.
+static void generateRain(size_t count, uint32_t seed, const WorldBounds& bounds, ThreadPool& pool,
+                         GeneratedScene& scene) {
+    const CellGrid grid(0.0f, 0.0f, bounds.width, bounds.height * 0.5f, count);
+    const float maxRadius = std::min(MAX_RADIUS, grid.cellSize() * 0.45f);
+    scene.balls.resize(count);
+    pool.parallelFor(count, GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            SceneBall& b = scene.balls[i];
+            b.radius = maxRadius * (0.5f + 0.5f * random01(seed, i, 0));
+            grid.place(i, b.radius, random01(seed, i, 1), random01(seed, i, 2), b.x, b.y);
+            b.vx = random01(seed, i, 3) * 200.0f - 100.0f;
+            b.vy = random01(seed, i, 4) * 200.0f;
+        }
+    });
+}
+
+// Equal balls in hexagonal rows on the floor, filling about half the world.
+static void generateHex(size_t count, const WorldBounds& bounds, ThreadPool& pool, GeneratedScene& scene) {
+    const float area = bounds.width * bounds.height * 0.5f;
+    const float radius = std::min(MAX_RADIUS, std::sqrt(area / (std::max<size_t>(count, 1) * 2.0f * SQRT3)) / GAP);
+    const float dx = 2.0f * radius * GAP;
+    const float dy = SQRT3 * radius * GAP;
+    const size_t columns = std::max<size_t>(1, static_cast<size_t>(bounds.width / dx - 0.5f));
+    scene.balls.resize(count);
+    pool.parallelFor(count, GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const size_t row = i / columns;
+            SceneBall& b = scene.balls[i];
+            b.radius = radius;
+            b.x = radius * GAP + (i % columns) * dx + (row % 2 ? dx * 0.5f : 0.0f);
+            b.y = bounds.height - radius * GAP - row * dy;
+            b.vx = 0.0f;
+            b.vy = 0.0f;
+        }
+    });
+}
+
+// Pyramids of balls standing on box platforms laid out in a grid.
+static void generatePyramids(size_t count, const WorldBounds& bounds, ThreadPool& pool, GeneratedScene& scene) {
+    const size_t pyramids = std::max<size_t>(1, static_cast<size_t>(std::lround(std::sqrt(count / PYRAMID_SIZE))));
+    const size_t perPyramid = std::max<size_t>(1, (count + pyramids - 1) / pyramids);
+    // Smallest base holding perPyramid balls.
+    size_t base = static_cast<size_t>(std::ceil((std::sqrt(8.0 * perPyramid + 1.0) - 1.0) / 2.0));
+    while (base * (base + 1) / 2 < perPyramid)
+        base++;
+
+    const CellGrid grid(0.0f, 0.0f, bounds.width, bounds.height, pyramids);
+    const float thickness = grid.cellHeight * 0.05f;
+    const float radius = std::min(MAX_RADIUS, std::min(grid.cellWidth * 0.45f / (base * GAP),
+                                                       (grid.cellHeight * 0.8f - thickness) /
+                                                           (((base - 1) * SQRT3 + 2.0f) * GAP)));
+    const float dx = 2.0f * radius * GAP;
+    const float dy = SQRT3 * radius * GAP;
+
+    scene.boxes.resize(pyramids);
+    scene.balls.resize(count);
+    pool.parallelFor(pyramids, 1, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; ++p) {
+            const float centreX = grid.x + ((p % grid.columns) + 0.5f) * grid.cellWidth;
+            const float floorY = grid.y + ((p / grid.columns) + 0.9f) * grid.cellHeight;
+            scene.boxes[p] = {centreX, floorY + thickness * 0.5f, base * dx + dx, thickness};
+
+            const size_t first = p * perPyramid;
+            const size_t last = std::min(count, first + perPyramid);
+            size_t row = 0, column = 0;
+            for (size_t i = first; i < last; ++i) {
+                const size_t rowLength = base - row;
+                SceneBall& b = scene.balls[i];
+                b.radius = radius;
+                b.x = centreX + (column - (rowLength - 1) * 0.5f) * dx;
+                b.y = floorY - radius * GAP - row * dy;
+                b.vx = 0.0f;
+                b.vy = 0.0f;
+                if (++column == rowLength) {
+                    column = 0;
+                    row++;
+                }
+            }
+        }
+    });
+}
+
+// A block of balls at the top above staggered rows of boxes.
+static void generateAvalanche(size_t count, uint32_t seed, const WorldBounds& bounds, ThreadPool& pool,
+                              GeneratedScene& scene) {
+    const size_t rows = 6;
+    const size_t columns = std::max<size_t>(3, static_cast<size_t>(bounds.width / 160.0f));
+    const float spacing = bounds.width / columns;
+    const float top = bounds.height * 0.35f;
+    const float rowHeight = bounds.height * 0.6f / rows;
+    const float boxHeight = std::max(4.0f, rowHeight * 0.1f);
+    for (size_t r = 0; r < rows; ++r) {
+        const float offset = r % 2 ? 0.0f : 0.5f;
+        for (size_t c = 0; c < columns + (r % 2); ++c)
+            scene.boxes.push_back({(c + offset) * spacing, top + (r + 0.5f) * rowHeight, spacing * 0.55f, boxHeight});
+    }
+
+    const CellGrid grid(0.0f, 0.0f, bounds.width, bounds.height * 0.3f, count);
+    const float radius = std::min(MAX_RADIUS, grid.cellSize() * 0.45f);
+    scene.balls.resize(count);
+    pool.parallelFor(count, GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            SceneBall& b = scene.balls[i];
+            b.radius = radius;
+            grid.place(i, radius, random01(seed, i, 0), random01(seed, i, 1), b.x, b.y);
+            b.vx = random01(seed, i, 2) * 20.0f - 10.0f;
+            b.vy = 0.0f;
+        }
+    });
+}
+
+// Small balls spread over the whole world, each with a random direction and
+// a speed of 1000 to 2000 pixels per second.
+static void generateGas(size_t count, uint32_t seed, const WorldBounds& bounds, ThreadPool& pool,
+                        GeneratedScene& scene) {
+    const CellGrid grid(0.0f, 0.0f, bounds.width, bounds.height, count);
+    const float radius = std::min(MAX_RADIUS * 0.5f, grid.cellSize() * 0.25f);
+    scene.balls.resize(count);
+    pool.parallelFor(count, GENERATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            SceneBall& b = scene.balls[i];
+            b.radius = radius;
+            grid.place(i, radius, random01(seed, i, 0), random01(seed, i, 1), b.x, b.y);
+            const float angle = random01(seed, i, 2) * 2.0f * PI;
+            const float speed = 1000.0f + 1000.0f * random01(seed, i, 3);
+            b.vx = std::cos(angle) * speed;
+            b.vy = std::sin(angle) * speed;
+        }
+    });
+}
+
+void generateScene(SceneKind kind, size_t count, uint32_t seed, const WorldBounds& bounds, ThreadPool& pool,
+                   GeneratedScene& scene) {
+    scene.balls.clear();
+    scene.boxes.clear();
+    if (count == 0)
+        return;
+    switch (kind) {
+        case SceneKind::RAIN: generateRain(count, seed, bounds, pool, scene); break;
+        case SceneKind::HEX: generateHex(count, bounds, pool, scene); break;
+        case SceneKind::PYRAMIDS: generatePyramids(count, bounds, pool, scene); break;
+        case SceneKind::AVALANCHE: generateAvalanche(count, seed, bounds, pool, scene); break;
+        case SceneKind::GAS: generateGas(count, seed, bounds, pool, scene); break;
+    }
+}
+
+bool parseSceneKind(const std::string& name, SceneKind& kind) {
+    for (SceneKind k : {SceneKind::RAIN, SceneKind::HEX, SceneKind::PYRAMIDS, SceneKind::AVALANCHE, SceneKind::GAS}) {
+        if (name == sceneKindName(k)) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* sceneKindName(SceneKind kind) {
+    switch (kind) {
+        case SceneKind::RAIN: return "rain";
+        case SceneKind::HEX: return "hex";
+        case SceneKind::PYRAMIDS: return "pyramids";
+        case SceneKind::AVALANCHE: return "avalanche";
+        case SceneKind::GAS: return "gas";
+    }
+    return "";
+}
@@ -0,0 +1,169 @@
+#include "scene_renderer.hpp"
+#include "render.hpp"
+#include "bitmap_font.hpp"
+#include "font_bitmap.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+// Balls with a smaller radius on screen, in pixels, are drawn by the LOD path.
+constexpr float LOD_RADIUS = 1.0f;
+// Most objects looked at per frame. Beyond this the view is sampled, so the
+// cost of a frame has an upper bound however many objects are visible.
+constexpr size_t MAX_VISIBLE = 1 << 18;
+// Most balls drawn as points; each is a draw command.
+constexpr size_t MAX_POINTS = 1 << 16;
+
+SceneRenderer::SceneRenderer(const WorldBounds& bounds)
+    : bounds(bounds)
+{}
+
+bool SceneRenderer::init(SDL_Renderer* renderer) {
+    // The font was rasterised at build time; load the embedded atlas.
+    BitmapFont bitmapFont;
+    if (!bitmapFont.load(font_bitmap, font_bitmap_len)) {
+        std::cerr << "Embedded font is corrupt\n";
+        return false;
+    }
+    if (!queue.init(renderer, bitmapFont)) {
+        std::cerr << "Font atlas Error: " << SDL_GetError() << "\n";
+        return false;
+    }
+    return true;
+}
+
+void SceneRenderer::releaseTextures() {
+    queue.releaseTextures();
+    rasterizer.releaseTexture();
+    densityMap.releaseTexture();
+}
+
+void SceneRenderer::draw(SDL_Renderer* renderer, const WorldSnapshot* snapshot, const ViewState& view,
+                         const char* hudText, ThreadPool* pool, const PerfHud* perfHud) {
+    SDL_GetRendererOutputSize(renderer, &viewWidth, &viewHeight);
+    visible.clear();
+    tiny.clear();
+    drawn = &visible;
+    sampleStride = 1;
+    if (snapshot) {
+        findVisible(*snapshot, view.camera);
+        if (view.lod != LodMode::OFF) {
+            splitBySize(*snapshot, view.camera);
+            drawn = &detailed;
+        }
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    const CircleStyle ballStyle = view.filledBalls ? CircleStyle::FILLED : CircleStyle::OUTLINE;
+    // Fall back to the queue if a streaming texture is not available.
+    const bool rasterized = view.cpuRaster && snapshot &&
+        rasterizer.draw(renderer, viewWidth, viewHeight, snapshot->objects, *drawn, view.camera, ballStyle, pool);
+    const bool heatmap = view.lod == LodMode::HEATMAP && !tiny.empty() &&
+        densityMap.draw(renderer, viewWidth, viewHeight, snapshot->objects, tiny,
+                        static_cast<uint32_t>(sampleStride), view.camera, pool);
+
+    commands.clear();
+    if (!heatmap && !tiny.empty()) {
+        SDL_Color white = {255, 255, 255, 255};
+        commands.setLayer(DrawLayer::WORLD);
+        const size_t stride = (tiny.size() + MAX_POINTS - 1) / MAX_POINTS;
+        for (size_t k = 0; k < tiny.size(); k += stride) {
+            const ObjectState& obj = snapshot->objects[tiny[k]];
+            commands.point(view.camera.toScreenX(obj.x), view.camera.toScreenY(obj.y), white);
+        }
+    }
+    record(snapshot, view, hudText, !rasterized, perfHud);
+    queue.execute(renderer, commands, view.spriteBalls, pool);
+}
+
+void SceneRenderer::findVisible(const WorldSnapshot& snapshot, const Camera& camera) {
+    // Objects inside the view, plus a margin for labels above them.
+    const float margin = queue.text().lineHeight() / camera.zoom;
+    sampleStride = snapshot.index().queryRectSampled(camera.toWorldX(0.0f) - margin, camera.toWorldY(0.0f) - margin,
+                                                     camera.toWorldX(static_cast<float>(viewWidth)) + margin,
+                                                     camera.toWorldY(static_cast<float>(viewHeight)) + margin,
+                                                     MAX_VISIBLE, visible);
+}
+
+void SceneRenderer::splitBySize(const WorldSnapshot& snapshot, const Camera& camera) {
+    const float minRadius = LOD_RADIUS / camera.zoom;
+    detailed.clear();
+    for (size_t i : visible) {
+        const ObjectState& obj = snapshot.objects[i];
+        if (obj.type == ObjectType::BALL && obj.radius < minRadius)
+            tiny.push_back(i);
+        else
+            detailed.push_back(i);
+    }
+}
+
+void SceneRenderer::record(const WorldSnapshot* snapshot, const ViewState& state, const char* hudText,
+                           bool recordObjects, const PerfHud* perfHud) {
+    const TextRenderer& text = queue.text();
+    const Camera& camera = state.camera;
+
+    commands.setLayer(DrawLayer::WORLD);
+    // Draw ground line.
+    if (bounds.hasWall(WALL_FLOOR)) {
+        SDL_Color ground = {150, 75, 0, 255};
+        const float groundY = camera.toScreenY(bounds.height) - 1.0f;
+        commands.line(camera.toScreenX(0.0f), groundY, camera.toScreenX(bounds.width), groundY, ground);
+    }
+
+    if (snapshot) {
+        const CircleStyle ballStyle = state.filledBalls ? CircleStyle::FILLED : CircleStyle::OUTLINE;
+        for (size_t i : *drawn) {
+            const ObjectState& obj = snapshot->objects[i];
+            if (recordObjects)
+                recordObject(commands, camera, obj, ballStyle);
+            if (state.showVelocityInfo && obj.type == ObjectType::BALL)
+                recordVelocityInfo(commands, text, camera, obj);
+        }
+
+        if (state.debugMode) {
+            commands.setLayer(DrawLayer::DEBUG);
+            for (size_t i : visible)
+                recordDebugInfo(commands, text, camera, snapshot->objects[i]);
+        }
+
+        // Highlight the selected object.
+        commands.setLayer(DrawLayer::OVERLAY);
+        for (size_t i : visible) {
+            const ObjectState& obj = snapshot->objects[i];
+            if (obj.handle == state.selectedObject) {
+                SDL_Color yellow = {255, 255, 0, 255};
+                commands.rect(boundingBox(camera, obj), yellow);
+                break;
+            }
+        }
+    }
+
+    commands.setLayer(DrawLayer::OVERLAY);
+    // Draw preview if dragging in box creation mode.
+    if (state.dragging && state.previewBoxMode) {
+        SDL_Rect previewRect;
+        previewRect.x = std::min(state.dragStartX, state.currentDragX);
+        previewRect.y = std::min(state.dragStartY, state.currentDragY);
+        previewRect.w = std::abs(state.currentDragX - state.dragStartX);
+        previewRect.h = std::abs(state.currentDragY - state.dragStartY);
+        // Semi-transparent fill with a solid border
+        SDL_Color fill = {0, 255, 0, 100};
+        SDL_Color border = {0, 255, 0, 255};
+        commands.fillRect(previewRect, fill, SDL_BLENDMODE_BLEND);
+        commands.rect(previewRect, border);
+    }
+    // If dragging and not in box mode, draw the drag vector for ball creation.
+    else if (state.dragging) {
+        SDL_Color green = {0, 255, 0, 255};
+        commands.aaLine(static_cast<float>(state.dragStartX), static_cast<float>(state.dragStartY),
+                        static_cast<float>(state.currentDragX), static_cast<float>(state.currentDragY), green);
+    }
+
+    commands.setLayer(DrawLayer::HUD);
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Color shadow = {0, 0, 0, 128};
+    commands.shadowedText(hudText, 10.0f, 10.0f, white, shadow);
+    if (perfHud && state.perfHud)
+        perfHud->record(commands, text, viewWidth - PerfHud::WIDTH - 10.0f, 10.0f);
+}
@@ -0,0 +1,77 @@
+#include "snapshot.hpp"
+#include "ball.hpp"
+#include "box.hpp"
+
+// Retired snapshots kept around for reuse.
+constexpr size_t MAX_RETIRED_SNAPSHOTS = 3;
+
+const SpatialIndex& WorldSnapshot::index() const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!indexBuilt) {
+        spatialIndex.build(objects);
+        indexBuilt = true;
+    }
+    return spatialIndex;
+}
+
+void WorldSnapshot::buildIndex(ThreadPool* pool) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    spatialIndex.build(objects, pool);
+    indexBuilt = true;
+}
+
+void WorldSnapshot::capture(const std::vector<Object*>& source) {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        indexBuilt = false;
+    }
+    objects.resize(source.size());
+    for (size_t i = 0; i < source.size(); ++i) {
+        const Object* obj = source[i];
+        ObjectState& s = objects[i];
+        s.type = obj->type;
+        s.handle = obj->handle;
+        s.x = obj->x;
+        s.y = obj->y;
+        s.vx = obj->vx;
+        s.vy = obj->vy;
+        if (obj->type == ObjectType::BALL) {
+            s.radius = static_cast<const Ball*>(obj)->radius;
+            s.width = s.height = 2.0f * s.radius;
+        } else {
+            const Box* box = static_cast<const Box*>(obj);
+            s.radius = 0.0f;
+            s.width = box->width;
+            s.height = box->height;
+        }
+    }
+}
+
+std::shared_ptr<WorldSnapshot> SnapshotBuffer::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Retired snapshots cannot be handed out by latest() any more, so a use
+    // count of one means nobody else can be reading it.
+    for (size_t i = 0; i < retired.size(); ++i) {
+        if (retired[i].use_count() == 1) {
+            std::shared_ptr<WorldSnapshot> snapshot = retired[i];
+            retired.erase(retired.begin() + i);
+            return snapshot;
+        }
+    }
+    return std::make_shared<WorldSnapshot>();
+}
+
+void SnapshotBuffer::publish(const std::shared_ptr<WorldSnapshot>& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current) {
+        retired.push_back(current);
+        if (retired.size() > MAX_RETIRED_SNAPSHOTS)
+            retired.erase(retired.begin());
+    }
+    current = snapshot;
+}
+
+std::shared_ptr<const WorldSnapshot> SnapshotBuffer::latest() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
@@ -0,0 +1,498 @@
+#include "spatial_index.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <functional>
+
+// Objects covering more cells than this go into the large item list.
+constexpr int MAX_ITEM_CELLS = 64;
+// Upper bound on the number of cells per indexed object.
+constexpr size_t CELLS_PER_OBJECT = 4;
+// Objects per unit of work when building in parallel.
+constexpr size_t BUILD_CHUNK = 16384;
+// Row bands the grid is split into when building; a fixed count, so the work
+// split does not depend on the number of threads.
+constexpr int BUILD_BANDS = 64;
+
+static void boundsOf(const ObjectState& s, float& minX, float& minY, float& maxX, float& maxY) {
+    if (s.type == ObjectType::BALL) {
+        minX = s.x - s.radius;
+        maxX = s.x + s.radius;
+        minY = s.y - s.radius;
+        maxY = s.y + s.radius;
+    } else {
+        minX = s.x - s.width * 0.5f;
+        maxX = s.x + s.width * 0.5f;
+        minY = s.y - s.height * 0.5f;
+        maxY = s.y + s.height * 0.5f;
+    }
+}
+
+static float clamp(float value, float min, float max) {
+    return std::max(min, std::min(value, max));
+}
+
+static bool containsPoint(const ObjectState& s, float x, float y) {
+    if (s.type == ObjectType::BALL) {
+        float dx = x - s.x, dy = y - s.y;
+        return dx * dx + dy * dy <= s.radius * s.radius;
+    }
+    return std::fabs(x - s.x) <= s.width * 0.5f && std::fabs(y - s.y) <= s.height * 0.5f;
+}
+
+static bool overlapsRect(const ObjectState& s, float minX, float minY, float maxX, float maxY) {
+    if (s.type == ObjectType::BALL) {
+        float dx = s.x - clamp(s.x, minX, maxX);
+        float dy = s.y - clamp(s.y, minY, maxY);
+        return dx * dx + dy * dy <= s.radius * s.radius;
+    }
+    float l, t, r, b;
+    boundsOf(s, l, t, r, b);
+    return l <= maxX && r >= minX && t <= maxY && b >= minY;
+}
+
+static bool overlapsCircle(const ObjectState& s, float x, float y, float radius) {
+    if (s.type == ObjectType::BALL) {
+        float dx = x - s.x, dy = y - s.y;
+        float reach = radius + s.radius;
+        return dx * dx + dy * dy <= reach * reach;
+    }
+    float l, t, r, b;
+    boundsOf(s, l, t, r, b);
+    float dx = x - clamp(x, l, r);
+    float dy = y - clamp(y, t, b);
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+// Ray (unit direction) against one object. Fills distance and normal on a hit.
+static bool intersectRay(const ObjectState& s, float ox, float oy, float dx, float dy,
+                         float& distance, float& nx, float& ny) {
+    if (s.type == ObjectType::BALL) {
+        float fx = ox - s.x, fy = oy - s.y;
+        float b = fx * dx + fy * dy;
+        float c = fx * fx + fy * fy - s.radius * s.radius;
+        if (c <= 0.0f) {
+            // Starting inside the ball.
+            distance = 0.0f;
+            nx = -dx;
+            ny = -dy;
+            return true;
+        }
+        float disc = b * b - c;
+        if (b > 0.0f || disc < 0.0f)
+            return false;
+        distance = -b - std::sqrt(disc);
+        nx = (fx + dx * distance) / s.radius;
+        ny = (fy + dy * distance) / s.radius;
+        return true;
+    }
+
+    float l, t, r, b;
+    boundsOf(s, l, t, r, b);
+    float tNear = 0.0f, tFar = std::numeric_limits<float>::max();
+    float normalX = -dx, normalY = -dy;
+    const float lo[2] = {l, t}, hi[2] = {r, b}, o[2] = {ox, oy}, d[2] = {dx, dy};
+    for (int axis = 0; axis < 2; ++axis) {
+        if (d[axis] == 0.0f) {
+            if (o[axis] < lo[axis] || o[axis] > hi[axis])
+                return false;
+            continue;
+        }
+        float inv = 1.0f / d[axis];
+        float t0 = (lo[axis] - o[axis]) * inv;
+        float t1 = (hi[axis] - o[axis]) * inv;
+        float sign = -1.0f;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+            sign = 1.0f;
+        }
+        if (t0 > tNear) {
+            tNear = t0;
+            normalX = axis == 0 ? sign : 0.0f;
+            normalY = axis == 1 ? sign : 0.0f;
+        }
+        tFar = std::min(tFar, t1);
+        if (tNear > tFar)
+            return false;
+    }
+    distance = tNear;
+    nx = normalX;
+    ny = normalY;
+    return true;
+}
+
+// Run fn over [0, count) on the pool, or inline without one.
+static void forChunks(ThreadPool* pool, size_t count, const std::function<void(size_t, size_t)>& fn) {
+    if (pool)
+        pool->parallelFor(count, 1, fn);
+    else
+        fn(0, count);
+}
+
+void SpatialIndex::build(const std::vector<ObjectState>& input, ThreadPool* pool) {
+    states = &input;
+    cellStart.clear();
+    cellItems.clear();
+    largeItems.clear();
+    columns = rows = 0;
+    const size_t n = input.size();
+    if (n == 0)
+        return;
+
+    // Bounds and ball sizes per fixed chunk of objects, combined in chunk
+    // order, so the grid does not depend on the number of threads.
+    const size_t chunks = (n + BUILD_CHUNK - 1) / BUILD_CHUNK;
+    struct Extent {
+        float minX, minY, maxX, maxY;
+        double ballDiameters;
+        size_t ballCount;
+    };
+    std::vector<Extent> extents(chunks);
+    forChunks(pool, chunks, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            Extent e = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                        -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), 0.0, 0};
+            for (size_t i = c * BUILD_CHUNK; i < std::min(n, (c + 1) * BUILD_CHUNK); ++i) {
+                const ObjectState& s = input[i];
+                float l, t, r, b;
+                boundsOf(s, l, t, r, b);
+                e.minX = std::min(e.minX, l);
+                e.minY = std::min(e.minY, t);
+                e.maxX = std::max(e.maxX, r);
+                e.maxY = std::max(e.maxY, b);
+                if (s.type == ObjectType::BALL) {
+                    e.ballDiameters += 2.0 * s.radius;
+                    e.ballCount++;
+                }
+            }
+            extents[c] = e;
+        }
+    });
+    float minX = extents[0].minX, minY = extents[0].minY;
+    float maxX = extents[0].maxX, maxY = extents[0].maxY;
+    double ballDiameters = 0.0;
+    size_t ballCount = 0;
+    for (const Extent& e : extents) {
+        minX = std::min(minX, e.minX);
+        minY = std::min(minY, e.minY);
+        maxX = std::max(maxX, e.maxX);
+        maxY = std::max(maxY, e.maxY);
+        ballDiameters += e.ballDiameters;
+        ballCount += e.ballCount;
+    }
+
+    // Cells about twice the average ball size, but never more cells than a
+    // small multiple of the object count.
+    const float spanX = std::max(maxX - minX, 1.0f);
+    const float spanY = std::max(maxY - minY, 1.0f);
+    cellSize = ballCount ? static_cast<float>(2.0 * ballDiameters / ballCount)
+                         : std::sqrt(spanX * spanY / n);
+    cellSize = std::max(cellSize, 1.0f);
+    const double maxCells = static_cast<double>(n * CELLS_PER_OBJECT + 16);
+    const double cells = std::ceil(spanX / cellSize) * std::ceil(spanY / cellSize);
+    if (cells > maxCells)
+        cellSize *= static_cast<float>(std::sqrt(cells / maxCells)) * 1.01f;
+
+    invCellSize = 1.0f / cellSize;
+    originX = minX;
+    originY = minY;
+    columns = std::max(1, static_cast<int>(std::ceil(spanX * invCellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(spanY * invCellSize)));
+
+    // Split the rows into bands and hand every object to the bands it
+    // touches. Each chunk counts per band first, so the lists can be filled
+    // in parallel and still hold every band's objects in ascending order.
+    const int bandRows = (rows + BUILD_BANDS - 1) / BUILD_BANDS;
+    const size_t bands = static_cast<size_t>((rows + bandRows - 1) / bandRows);
+    bandCounts.assign(chunks * bands, 0);
+    ranges.resize(2 * n);
+    std::vector<std::vector<uint32_t>> chunkLarge(chunks);
+    forChunks(pool, chunks, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            uint32_t* counts = &bandCounts[c * bands];
+            for (size_t i = c * BUILD_CHUNK; i < std::min(n, (c + 1) * BUILD_CHUNK); ++i) {
+                Cell& lo = ranges[2 * i];
+                Cell& hi = ranges[2 * i + 1];
+                cellRange(i, lo, hi);
+                if ((hi.x - lo.x + 1) * (hi.y - lo.y + 1) > MAX_ITEM_CELLS) {
+                    chunkLarge[c].push_back(static_cast<uint32_t>(i));
+                    // Touches no band.
+                    hi.y = lo.y - 1;
+                    continue;
+                }
+                for (int band = lo.y / bandRows; band <= hi.y / bandRows; ++band)
+                    counts[band]++;
+            }
+        }
+    });
+    for (const std::vector<uint32_t>& large : chunkLarge)
+        largeItems.insert(largeItems.end(), large.begin(), large.end());
+
+    // Turn the counts into each chunk's first slot in each band's list.
+    bandStart.assign(bands + 1, 0);
+    for (size_t band = 0; band < bands; ++band) {
+        uint32_t offset = bandStart[band];
+        for (size_t c = 0; c < chunks; ++c) {
+            const uint32_t count = bandCounts[c * bands + band];
+            bandCounts[c * bands + band] = offset;
+            offset += count;
+        }
+        bandStart[band + 1] = offset;
+    }
+    bandItems.resize(bandStart.back());
+    forChunks(pool, chunks, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            uint32_t* next = &bandCounts[c * bands];
+            for (size_t i = c * BUILD_CHUNK; i < std::min(n, (c + 1) * BUILD_CHUNK); ++i) {
+                const Cell lo = ranges[2 * i], hi = ranges[2 * i + 1];
+                if (hi.y < lo.y)
+                    continue;
+                for (int band = lo.y / bandRows; band <= hi.y / bandRows; ++band)
+                    bandItems[next[band]++] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+
+    // Counting sort of (cell, item) pairs per band. A band owns a contiguous
+    // range of cells, so bands never write to the same entries.
+    cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    fill.resize(cellStart.size() - 1);
+    forChunks(pool, bands, [&](size_t first, size_t last) {
+        for (size_t band = first; band < last; ++band) {
+            const int firstRow = static_cast<int>(band) * bandRows;
+            const int lastRow = std::min(rows, firstRow + bandRows) - 1;
+            for (uint32_t k = bandStart[band]; k < bandStart[band + 1]; ++k) {
+                const uint32_t i = bandItems[k];
+                const Cell lo = ranges[2 * i], hi = ranges[2 * i + 1];
+                for (int cy = std::max(lo.y, firstRow); cy <= std::min(hi.y, lastRow); ++cy)
+                    for (int cx = lo.x; cx <= hi.x; ++cx)
+                        cellStart[static_cast<size_t>(cy) * columns + cx + 1]++;
+            }
+        }
+    });
+    for (size_t c = 1; c < cellStart.size(); ++c)
+        cellStart[c] += cellStart[c - 1];
+    cellItems.resize(cellStart.back());
+
+    std::copy(cellStart.begin(), cellStart.end() - 1, fill.begin());
+    forChunks(pool, bands, [&](size_t first, size_t last) {
+        for (size_t band = first; band < last; ++band) {
+            const int firstRow = static_cast<int>(band) * bandRows;
+            const int lastRow = std::min(rows, firstRow + bandRows) - 1;
+            for (uint32_t k = bandStart[band]; k < bandStart[band + 1]; ++k) {
+                const uint32_t i = bandItems[k];
+                const Cell lo = ranges[2 * i], hi = ranges[2 * i + 1];
+                for (int cy = std::max(lo.y, firstRow); cy <= std::min(hi.y, lastRow); ++cy)
+                    for (int cx = lo.x; cx <= hi.x; ++cx)
+                        cellItems[fill[static_cast<size_t>(cy) * columns + cx]++] = i;
+            }
+        }
+    });
+}
+
+SpatialIndex::Cell SpatialIndex::cellOf(float x, float y) const {
+    Cell c;
+    c.x = static_cast<int>(clamp(std::floor((x - originX) * invCellSize), 0.0f, static_cast<float>(columns - 1)));
+    c.y = static_cast<int>(clamp(std::floor((y - originY) * invCellSize), 0.0f, static_cast<float>(rows - 1)));
+    return c;
+}
+
+void SpatialIndex::cellRange(size_t item, Cell& lo, Cell& hi) const {
+    float l, t, r, b;
+    boundsOf((*states)[item], l, t, r, b);
+    lo = cellOf(l, t);
+    hi = cellOf(r, b);
+}
+
+// Visit the cells overlapping a rectangle and collect the items passing the
+// overlap test. An item in several cells is only reported from the first
+// visited cell it occupies, so no deduplication pass is needed.
+template <typename Overlaps>
+void SpatialIndex::queryCells(float minX, float minY, float maxX, float maxY, Overlaps overlaps,
+                              std::vector<size_t>& out, bool sorted) const {
+    out.clear();
+    if (!states || states->empty())
+        return;
+
+    for (uint32_t item : largeItems)
+        if (overlaps((*states)[item]))
+            out.push_back(item);
+
+    if (columns > 0 && maxX >= originX && maxY >= originY &&
+        minX <= originX + columns * cellSize && minY <= originY + rows * cellSize) {
+        Cell lo = cellOf(minX, minY);
+        Cell hi = cellOf(maxX, maxY);
+        for (int cy = lo.y; cy <= hi.y; ++cy) {
+            for (int cx = lo.x; cx <= hi.x; ++cx) {
+                const size_t cell = static_cast<size_t>(cy) * columns + cx;
+                for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    const uint32_t item = cellItems[k];
+                    Cell itemLo, itemHi;
+                    cellRange(item, itemLo, itemHi);
+                    if (std::max(itemLo.x, lo.x) != cx || std::max(itemLo.y, lo.y) != cy)
+                        continue;
+                    if (overlaps((*states)[item]))
+                        out.push_back(item);
+                }
+            }
+        }
+    }
+    if (sorted)
+        std::sort(out.begin(), out.end());
+}
+
+void SpatialIndex::queryPoint(float x, float y, std::vector<size_t>& out) const {
+    queryCells(x, y, x, y, [&](const ObjectState& s) { return containsPoint(s, x, y); }, out);
+}
+
+void SpatialIndex::queryRect(float minX, float minY, float maxX, float maxY, std::vector<size_t>& out) const {
+    queryCells(minX, minY, maxX, maxY,
+               [&](const ObjectState& s) { return overlapsRect(s, minX, minY, maxX, maxY); }, out);
+}
+
+void SpatialIndex::queryRectUnordered(float minX, float minY, float maxX, float maxY,
+                                      std::vector<size_t>& out) const {
+    queryCells(minX, minY, maxX, maxY,
+               [&](const ObjectState& s) { return overlapsRect(s, minX, minY, maxX, maxY); }, out, false);
+}
+
+size_t SpatialIndex::queryRectSampled(float minX, float minY, float maxX, float maxY, size_t maxItems,
+                                      std::vector<size_t>& out) const {
+    out.clear();
+    if (!states || states->empty())
+        return 1;
+    for (uint32_t item : largeItems)
+        if (overlapsRect((*states)[item], minX, minY, maxX, maxY))
+            out.push_back(item);
+    if (columns == 0 || maxX < originX || maxY < originY ||
+        minX > originX + columns * cellSize || minY > originY + rows * cellSize)
+        return 1;
+
+    // The cells of a row are contiguous in cellItems, so the entries under
+    // the rectangle can be counted per row without visiting the cells.
+    const Cell lo = cellOf(minX, minY);
+    const Cell hi = cellOf(maxX, maxY);
+    size_t entries = 0;
+    for (int cy = lo.y; cy <= hi.y; ++cy) {
+        const size_t row = static_cast<size_t>(cy) * columns;
+        entries += cellStart[row + hi.x + 1] - cellStart[row + lo.x];
+    }
+    const size_t stride = entries > maxItems ? (entries + maxItems - 1) / maxItems : 1;
+
+    // Every stride-th entry, counted across rows. An object in several cells
+    // is only reported from its first cell in the rectangle, as in queryCells.
+    size_t seen = 0, next = 0;
+    for (int cy = lo.y; cy <= hi.y; ++cy) {
+        const size_t row = static_cast<size_t>(cy) * columns;
+        const size_t first = cellStart[row + lo.x];
+        const size_t last = cellStart[row + hi.x + 1];
+        size_t k = first + (next - seen);
+        for (; k < last; k += stride) {
+            const uint32_t item = cellItems[k];
+            Cell itemLo, itemHi;
+            cellRange(item, itemLo, itemHi);
+            if (std::max(itemLo.y, lo.y) != cy)
+                continue;
+            const size_t cell = row + std::max(itemLo.x, lo.x);
+            if (k < cellStart[cell] || k >= cellStart[cell + 1])
+                continue;
+            if (overlapsRect((*states)[item], minX, minY, maxX, maxY))
+                out.push_back(item);
+        }
+        next = seen + (k - first);
+        seen += last - first;
+    }
+    return stride;
+}
+
+void SpatialIndex::queryCircle(float x, float y, float radius, std::vector<size_t>& out) const {
+    queryCells(x - radius, y - radius, x + radius, y + radius,
+               [&](const ObjectState& s) { return overlapsCircle(s, x, y, radius); }, out);
+}
+
+bool SpatialIndex::rayCast(float ox, float oy, float dx, float dy, float maxDistance, RayHit& hit) const {
+    if (!states || states->empty())
+        return false;
+    float length = std::hypot(dx, dy);
+    if (length == 0.0f)
+        return false;
+    dx /= length;
+    dy /= length;
+
+    bool found = false;
+    auto test = [&](uint32_t item) {
+        float distance, nx, ny;
+        if (!intersectRay((*states)[item], ox, oy, dx, dy, distance, nx, ny))
+            return;
+        if (distance > maxDistance)
+            return;
+        // Ties go to the lower index so the result does not depend on visiting order.
+        if (!found || distance < hit.distance || (distance == hit.distance && item < hit.index)) {
+            found = true;
+            hit.index = item;
+            hit.distance = distance;
+            hit.x = ox + dx * distance;
+            hit.y = oy + dy * distance;
+            hit.nx = nx;
+            hit.ny = ny;
+        }
+    };
+
+    for (uint32_t item : largeItems)
+        test(item);
+
+    // Clip the ray to the grid.
+    const float gridMin[2] = {originX, originY};
+    const float gridMax[2] = {originX + columns * cellSize, originY + rows * cellSize};
+    const float o[2] = {ox, oy}, d[2] = {dx, dy};
+    float tEnter = 0.0f, tExit = maxDistance;
+    for (int axis = 0; axis < 2; ++axis) {
+        if (d[axis] == 0.0f) {
+            if (o[axis] < gridMin[axis] || o[axis] > gridMax[axis])
+                return found;
+            continue;
+        }
+        float t0 = (gridMin[axis] - o[axis]) / d[axis];
+        float t1 = (gridMax[axis] - o[axis]) / d[axis];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+    }
+    if (tEnter > tExit)
+        return found;
+
+    // Walk the cells along the ray (Amanatides & Woo).
+    Cell cell = cellOf(ox + dx * tEnter, oy + dy * tEnter);
+    const int stepX = dx > 0.0f ? 1 : -1;
+    const int stepY = dy > 0.0f ? 1 : -1;
+    const float inf = std::numeric_limits<float>::max();
+    const float deltaX = dx != 0.0f ? cellSize / std::fabs(dx) : inf;
+    const float deltaY = dy != 0.0f ? cellSize / std::fabs(dy) : inf;
+    float nextX = inf, nextY = inf;
+    if (dx != 0.0f)
+        nextX = (originX + (cell.x + (stepX > 0 ? 1 : 0)) * cellSize - ox) / dx;
+    if (dy != 0.0f)
+        nextY = (originY + (cell.y + (stepY > 0 ? 1 : 0)) * cellSize - oy) / dy;
+
+    for (;;) {
+        const size_t c = static_cast<size_t>(cell.y) * columns + cell.x;
+        for (uint32_t k = cellStart[c]; k < cellStart[c + 1]; ++k)
+            test(cellItems[k]);
+        const float cellExit = std::min(nextX, nextY);
+        if ((found && hit.distance <= cellExit) || cellExit > tExit)
+            break;
+        if (nextX < nextY) {
+            cell.x += stepX;
+            nextX += deltaX;
+            if (cell.x < 0 || cell.x >= columns)
+                break;
+        } else {
+            cell.y += stepY;
+            nextY += deltaY;
+            if (cell.y < 0 || cell.y >= rows)
+                break;
+        }
+    }
+    return found;
+}
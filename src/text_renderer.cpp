@@ -0,0 +1,88 @@
+#include "text_renderer.hpp"
+#include <algorithm>
+#include <cstring>
+
+bool TextRenderer::init(SDL_Renderer* renderer, const BitmapFont& source) {
+    releaseTexture();
+    if (source.width <= 0 || source.height <= 0)
+        return false;
+
+    // White pixels with the glyph coverage as alpha, so the vertex colour tints them.
+    std::vector<uint32_t> pixels(source.coverage.size());
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        uint8_t rgba[4] = {255, 255, 255, source.coverage[i]};
+        std::memcpy(&pixels[i], rgba, sizeof(uint32_t));
+    }
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                source.width, source.height);
+    if (!texture)
+        return false;
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_UpdateTexture(texture, nullptr, pixels.data(), source.width * static_cast<int>(sizeof(uint32_t)));
+
+    font.width = source.width;
+    font.height = source.height;
+    font.lineHeight = source.lineHeight;
+    std::copy(source.glyphs, source.glyphs + BitmapFont::GLYPH_COUNT, font.glyphs);
+    invWidth = 1.0f / source.width;
+    invHeight = 1.0f / source.height;
+    return true;
+}
+
+void TextRenderer::add(const char* text, float x, float y, SDL_Color color) {
+    if (!texture || !text)
+        return;
+    // Snap to whole pixels; glyphs are drawn 1:1 with the atlas.
+    float penX = static_cast<float>(static_cast<int>(x));
+    const float top = static_cast<float>(static_cast<int>(y));
+    for (const char* c = text; *c; ++c) {
+        const Glyph* g = font.glyph(*c);
+        if (!g)
+            continue;
+        if (g->width != 0) {
+            const float x0 = penX + g->offsetX, x1 = x0 + g->width;
+            const float y0 = top + g->offsetY, y1 = y0 + g->height;
+            const float u0 = g->x * invWidth, u1 = (g->x + g->width) * invWidth;
+            const float v0 = g->y * invHeight, v1 = (g->y + g->height) * invHeight;
+            const float xs[4] = {x0, x1, x1, x0};
+            const float ys[4] = {y0, y0, y1, y1};
+            const float us[4] = {u0, u1, u1, u0};
+            const float vs[4] = {v0, v0, v1, v1};
+            const int base = static_cast<int>(vertices.size());
+            for (int k = 0; k < 4; ++k) {
+                SDL_Vertex v;
+                v.position.x = xs[k];
+                v.position.y = ys[k];
+                v.color = color;
+                v.tex_coord.x = us[k];
+                v.tex_coord.y = vs[k];
+                vertices.push_back(v);
+            }
+            const int quad[6] = {base, base + 1, base + 2, base, base + 2, base + 3};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+        penX += g->advance;
+    }
+}
+
+void TextRenderer::measure(const char* text, int& width, int& height) const {
+    width = 0;
+    height = font.lineHeight;
+    for (const char* c = text; c && *c; ++c)
+        if (const Glyph* g = font.glyph(*c))
+            width += g->advance;
+}
+
+void TextRenderer::draw(SDL_Renderer* renderer) {
+    if (texture && !indices.empty())
+        SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+    vertices.clear();
+    indices.clear();
+}
+
+void TextRenderer::releaseTexture() {
+    if (texture)
+        SDL_DestroyTexture(texture);
+    texture = nullptr;
+}
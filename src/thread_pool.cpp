@@ -0,0 +1,79 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : stopping(false), generation(0), busyWorkers(0),
+      job(nullptr), jobCount(0), jobChunk(1), nextIndex(0)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < threadCount; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0)
+        return;
+    grain = std::max<size_t>(grain, 1);
+    // Not worth waking anybody up.
+    if (workers.empty() || count <= grain) {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        // A few chunks per thread keeps the load balanced without much overhead.
+        jobChunk = std::max(grain, (count + size() * 4 - 1) / (size() * 4));
+        nextIndex.store(0);
+        busyWorkers = static_cast<unsigned>(workers.size());
+        ++generation;
+    }
+    wakeCondition.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::runChunks() {
+    for (;;) {
+        size_t begin = nextIndex.fetch_add(jobChunk);
+        if (begin >= jobCount)
+            break;
+        (*job)(begin, std::min(begin + jobChunk, jobCount));
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+        }
+        runChunks();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busyWorkers;
+        }
+        doneCondition.notify_one();
+    }
+}
@@ -0,0 +1,200 @@
+#include "tile_rasterizer.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Tile edge in pixels. 64 * 64 * 4 bytes fits in L1 on most cores.
+constexpr int TILE_SIZE = 64;
+// Objects binned by one task.
+constexpr size_t BIN_CHUNK = 16384;
+// Balls smaller than this are drawn as one pixel.
+constexpr float POINT_RADIUS = 0.75f;
+
+constexpr uint32_t BACKGROUND = 0xFF000000;
+constexpr uint32_t BALL_COLOR = 0xFFFFFFFF;
+constexpr uint32_t BOX_COLOR = 0xFFB4B4B4;
+
+// std::floor without the library call; the values are always small.
+static int floorToInt(float value) {
+    const int i = static_cast<int>(value);
+    return i - (value < static_cast<float>(i) ? 1 : 0);
+}
+
+static int ceilToInt(float value) {
+    return -floorToInt(-value);
+}
+
+// Fill columns [x0, x1] of a row, clipped to [minX, maxX]. The compiler turns
+// the fill into vector stores.
+static void fillSpan(uint32_t* row, int x0, int x1, int minX, int maxX, uint32_t color) {
+    x0 = std::max(x0, minX);
+    x1 = std::min(x1, maxX);
+    if (x0 <= x1)
+        std::fill(row + x0, row + x1 + 1, color);
+}
+
+TileRasterizer::~TileRasterizer() {
+    releaseTexture();
+}
+
+void TileRasterizer::releaseTexture() {
+    if (texture)
+        SDL_DestroyTexture(texture);
+    texture = nullptr;
+    textureWidth = textureHeight = 0;
+}
+
+bool TileRasterizer::ensureTexture(SDL_Renderer* renderer, int width, int height) {
+    if (texture && width == textureWidth && height == textureHeight)
+        return true;
+    releaseTexture();
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!texture)
+        return false;
+    // Every pixel is written each frame, so the copy can skip blending.
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    textureWidth = width;
+    textureHeight = height;
+    return true;
+}
+
+bool TileRasterizer::draw(SDL_Renderer* renderer, int width, int height, const std::vector<ObjectState>& objects,
+                          const std::vector<size_t>& visible, const Camera& camera, CircleStyle ballStyle,
+                          ThreadPool* pool) {
+    if (width <= 0 || height <= 0 || !ensureTexture(renderer, width, height))
+        return false;
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    const size_t chunks = (visible.size() + BIN_CHUNK - 1) / BIN_CHUNK;
+    chunkBins.resize(chunks);
+    auto binChunks = [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c)
+            bin(c, objects, visible, camera);
+    };
+    if (pool)
+        pool->parallelFor(chunks, 1, binChunks);
+    else
+        binChunks(0, chunks);
+
+    void* locked;
+    int pitch;
+    if (SDL_LockTexture(texture, nullptr, &locked, &pitch) != 0)
+        return false;
+    uint8_t* pixels = static_cast<uint8_t*>(locked);
+    const size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+    auto fillTiles = [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t)
+            fillTile(t, pixels, pitch, ballStyle);
+    };
+    if (pool)
+        pool->parallelFor(tileCount, 1, fillTiles);
+    else
+        fillTiles(0, tileCount);
+    SDL_UnlockTexture(texture);
+
+    return SDL_RenderCopy(renderer, texture, nullptr, nullptr) == 0;
+}
+
+void TileRasterizer::bin(size_t chunk, const std::vector<ObjectState>& objects, const std::vector<size_t>& visible,
+                         const Camera& camera) {
+    std::vector<std::vector<Shape>>& bins = chunkBins[chunk];
+    bins.resize(static_cast<size_t>(tilesX) * tilesY);
+    for (auto& tile : bins)
+        tile.clear();
+
+    const size_t end = std::min(visible.size(), (chunk + 1) * BIN_CHUNK);
+    for (size_t i = chunk * BIN_CHUNK; i < end; ++i) {
+        const ObjectState& obj = objects[visible[i]];
+        Shape s;
+        float minX, minY, maxX, maxY;
+        if (obj.type == ObjectType::BALL) {
+            s.x = camera.toScreenX(obj.x);
+            s.y = camera.toScreenY(obj.y);
+            s.radius = obj.radius * camera.zoom;
+            s.width = s.height = 0.0f;
+            s.color = BALL_COLOR;
+            minX = s.x - s.radius;
+            maxX = s.x + s.radius;
+            minY = s.y - s.radius;
+            maxY = s.y + s.radius;
+        } else {
+            // Same rounding as boundingBox() in render.cpp so both renderers agree.
+            s.x = static_cast<float>(static_cast<int>(camera.toScreenX(obj.x - obj.width * 0.5f)));
+            s.y = static_cast<float>(static_cast<int>(camera.toScreenY(obj.y - obj.height * 0.5f)));
+            s.radius = 0.0f;
+            s.width = static_cast<float>(static_cast<int>(obj.width * camera.zoom));
+            s.height = static_cast<float>(static_cast<int>(obj.height * camera.zoom));
+            s.color = BOX_COLOR;
+            minX = s.x;
+            maxX = s.x + s.width;
+            minY = s.y;
+            maxY = s.y + s.height;
+        }
+        const int tx0 = std::max(0, floorToInt(minX) / TILE_SIZE);
+        const int ty0 = std::max(0, floorToInt(minY) / TILE_SIZE);
+        const int tx1 = std::min(tilesX - 1, floorToInt(maxX) / TILE_SIZE);
+        const int ty1 = std::min(tilesY - 1, floorToInt(maxY) / TILE_SIZE);
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx)
+                bins[static_cast<size_t>(ty) * tilesX + tx].push_back(s);
+    }
+}
+
+void TileRasterizer::fillTile(size_t tile, uint8_t* pixels, int pitch, CircleStyle ballStyle) const {
+    const int minX = static_cast<int>(tile % tilesX) * TILE_SIZE;
+    const int minY = static_cast<int>(tile / tilesX) * TILE_SIZE;
+    const int maxX = std::min(minX + TILE_SIZE, textureWidth) - 1;
+    const int maxY = std::min(minY + TILE_SIZE, textureHeight) - 1;
+    auto row = [&](int y) {
+        return reinterpret_cast<uint32_t*>(pixels + static_cast<size_t>(y) * pitch);
+    };
+
+    for (int y = minY; y <= maxY; ++y)
+        std::fill(row(y) + minX, row(y) + maxX + 1, BACKGROUND);
+
+    for (const auto& bins : chunkBins) {
+        for (const Shape& s : bins[tile]) {
+            if (s.radius == 0.0f) {
+                const int x0 = static_cast<int>(s.x);
+                const int x1 = x0 + static_cast<int>(s.width) - 1;
+                const int y0 = std::max(minY, static_cast<int>(s.y));
+                const int y1 = std::min(maxY, static_cast<int>(s.y) + static_cast<int>(s.height) - 1);
+                for (int y = y0; y <= y1; ++y)
+                    fillSpan(row(y), x0, x1, minX, maxX, s.color);
+                continue;
+            }
+
+            if (s.radius < POINT_RADIUS) {
+                const int x = floorToInt(s.x);
+                const int y = floorToInt(s.y);
+                if (x >= minX && x <= maxX && y >= minY && y <= maxY)
+                    row(y)[x] = s.color;
+                continue;
+            }
+
+            // Pixels whose centres lie inside the circle, row by row. Outlines
+            // leave out the span of a circle one pixel smaller.
+            const float outer2 = s.radius * s.radius;
+            const float inner = s.radius - 1.0f;
+            const float inner2 = ballStyle == CircleStyle::OUTLINE && inner > 0.0f ? inner * inner : -1.0f;
+            const int y0 = std::max(minY, floorToInt(s.y - s.radius));
+            const int y1 = std::min(maxY, ceilToInt(s.y + s.radius));
+            for (int y = y0; y <= y1; ++y) {
+                const float dy = y + 0.5f - s.y;
+                const float dy2 = dy * dy;
+                if (dy2 > outer2)
+                    continue;
+                const float half = std::sqrt(outer2 - dy2);
+                const int x0 = ceilToInt(s.x - half - 0.5f);
+                const int x1 = floorToInt(s.x + half - 0.5f);
+                if (dy2 < inner2) {
+                    const float innerHalf = std::sqrt(inner2 - dy2);
+                    fillSpan(row(y), x0, ceilToInt(s.x - innerHalf - 0.5f) - 1, minX, maxX, s.color);
+                    fillSpan(row(y), floorToInt(s.x + innerHalf - 0.5f) + 1, x1, minX, maxX, s.color);
+                } else {
+                    fillSpan(row(y), x0, x1, minX, maxX, s.color);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,200 @@
+#include "world.hpp"
+#include "ball.hpp"
+#include "box.hpp"
+#include <cmath>
+#include <algorithm>
+
+ObjectHandle World::spawnBall(float x, float y, float vx, float vy, float radius) {
+    ObjectHandle handle = pool.create<Ball>(x, y, vx, vy, radius);
+    added(handle);
+    balls++;
+    // Once full, drop handles of balls that were removed some other way.
+    if (spawnCount == spawnOrder.size())
+        compactSpawnOrder();
+    spawnOrder[spawnSlot(spawnCount++)] = handle;
+    if (lifetime.maxBalls != 0) {
+        while (balls > lifetime.maxBalls)
+            evictOldest();
+    }
+    return handle;
+}
+
+ObjectHandle World::spawnBox(float x, float y, float width, float height) {
+    ObjectHandle handle = pool.create<Box>(x, y, width, height);
+    added(handle);
+    return handle;
+}
+
+bool World::despawn(ObjectHandle handle) {
+    Object* obj = pool.get(handle);
+    if (!obj)
+        return false;
+    if (obj->type == ObjectType::BALL)
+        balls--;
+
+    // Swap and pop, then point the moved object's slot at its new place.
+    const uint32_t index = denseIndex[handle.index];
+    const size_t last = objects.size() - 1;
+    if (index != last) {
+        objects[index] = objects[last];
+        lives[index] = lives[last];
+        denseIndex[objects[index]->handle.index] = index;
+    }
+    objects.pop_back();
+    lives.pop_back();
+    pool.destroy(handle);
+    return true;
+}
+
+void World::updateLifetimes(float dt) {
+    time += dt;
+    const LifetimePolicy policy = lifetime;
+    if (policy.timeToLive <= 0.0f && policy.sleepTimeout <= 0.0f && policy.offWorldTimeout <= 0.0f)
+        return;
+
+    // Walk backwards: despawn moves the last object into the freed place, and
+    // that one has already been visited.
+    for (size_t i = objects.size(); i-- > 0;) {
+        Object* obj = objects[i];
+        if (obj->type != ObjectType::BALL)
+            continue;
+        const Ball* ball = static_cast<const Ball*>(obj);
+        Life& life = lives[i];
+
+        if (std::fabs(ball->vx) < REST_SPEED && std::fabs(ball->vy) < REST_SPEED)
+            life.restTime += dt;
+        else
+            life.restTime = 0.0f;
+
+        if (ball->x + ball->radius < 0 || ball->x - ball->radius > bounds.width ||
+            ball->y + ball->radius < 0 || ball->y - ball->radius > bounds.height)
+            life.offWorldTime += dt;
+        else
+            life.offWorldTime = 0.0f;
+
+        if ((policy.timeToLive > 0.0f && time - life.spawnTime > policy.timeToLive) ||
+            (policy.sleepTimeout > 0.0f && life.restTime > policy.sleepTimeout) ||
+            (policy.offWorldTimeout > 0.0f && life.offWorldTime > policy.offWorldTimeout))
+            despawn(obj->handle);
+    }
+}
+
+void World::reserve(size_t count) {
+    pool.reserve(count);
+    reserveDense(pool.capacity());
+}
+
+void World::reserveDense(size_t count) {
+    if (denseIndex.size() >= count)
+        return;
+    objects.reserve(count);
+    lives.reserve(count);
+    denseIndex.resize(count);
+    // Unroll the ring before growing it.
+    std::rotate(spawnOrder.begin(), spawnOrder.begin() + spawnFront, spawnOrder.end());
+    spawnFront = 0;
+    spawnOrder.resize(2 * count);
+}
+
+void World::clear() {
+    objects.clear();
+    lives.clear();
+    spawnFront = spawnCount = 0;
+    balls = 0;
+    pool.clear();
+}
+
+void World::saveState(WorldState& state) const {
+    state.bounds = bounds;
+    state.params = params;
+    state.time = time;
+    state.objects.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const Object* obj = objects[i];
+        WorldState::Entry& e = state.objects[i];
+        e.type = obj->type;
+        e.x = obj->x;
+        e.y = obj->y;
+        e.vx = obj->vx;
+        e.vy = obj->vy;
+        if (obj->type == ObjectType::BALL) {
+            e.radius = static_cast<const Ball*>(obj)->radius;
+            e.width = e.height = 0.0f;
+        } else {
+            const Box* box = static_cast<const Box*>(obj);
+            e.radius = 0.0f;
+            e.width = box->width;
+            e.height = box->height;
+        }
+        e.spawnTime = lives[i].spawnTime;
+        e.restTime = lives[i].restTime;
+        e.offWorldTime = lives[i].offWorldTime;
+    }
+
+    // Stale handles are dropped; eviction skips them anyway.
+    state.spawnOrder.clear();
+    for (size_t i = 0; i < spawnCount; ++i) {
+        const ObjectHandle& h = spawnOrder[spawnSlot(i)];
+        if (pool.get(h))
+            state.spawnOrder.push_back(denseIndex[h.index]);
+    }
+}
+
+void World::restoreState(const WorldState& state) {
+    clear();
+    bounds = state.bounds;
+    params = state.params;
+    time = state.time;
+    reserve(state.objects.size());
+    for (const WorldState::Entry& e : state.objects) {
+        ObjectHandle handle;
+        if (e.type == ObjectType::BALL) {
+            handle = pool.create<Ball>(e.x, e.y, e.vx, e.vy, e.radius);
+            balls++;
+        } else {
+            handle = pool.create<Box>(e.x, e.y, e.width, e.height);
+        }
+        added(handle);
+        Life& life = lives.back();
+        life.spawnTime = e.spawnTime;
+        life.restTime = e.restTime;
+        life.offWorldTime = e.offWorldTime;
+    }
+    for (uint32_t index : state.spawnOrder)
+        spawnOrder[spawnSlot(spawnCount++)] = objects[index]->handle;
+}
+
+void World::added(ObjectHandle handle) {
+    // Grow the dense lists at least twice as large whenever the pool outgrows
+    // them, so spawning one object at a time copies each entry O(1) times.
+    if (denseIndex.size() < pool.capacity())
+        reserveDense(std::max(pool.capacity(), 2 * denseIndex.size()));
+    denseIndex[handle.index] = static_cast<uint32_t>(objects.size());
+    objects.push_back(pool.get(handle));
+    Life life;
+    life.spawnTime = time;
+    life.restTime = 0.0f;
+    life.offWorldTime = 0.0f;
+    lives.push_back(life);
+}
+
+void World::evictOldest() {
+    while (spawnCount > 0) {
+        const ObjectHandle oldest = spawnOrder[spawnFront];
+        spawnFront = spawnSlot(1);
+        spawnCount--;
+        if (despawn(oldest))
+            return;
+    }
+}
+
+void World::compactSpawnOrder() {
+    // Live handles move towards the front, never past one still to be read.
+    size_t live = 0;
+    for (size_t i = 0; i < spawnCount; ++i) {
+        const ObjectHandle h = spawnOrder[spawnSlot(i)];
+        if (pool.get(h))
+            spawnOrder[spawnSlot(live++)] = h;
+    }
+    spawnCount = live;
+}
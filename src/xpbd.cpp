@@ -0,0 +1,322 @@
+#include "xpbd.hpp"
+#include "ball.hpp"
+#include "box.hpp"
+#include <cmath>
+#include <algorithm>
+
+// Slack added around every ball during detection, in pixels.
+constexpr float DETECTION_SLACK = 1.0f;
+
+// Objects and contacts per task.
+constexpr size_t BODY_GRAIN = 256;
+constexpr size_t CONTACT_GRAIN = 64;
+
+// Move a ball out of a box. Returns false if they do not touch.
+// The normal points out of the box towards the ball.
+static bool projectBallBox(Ball* ball, const Box* box, float alphaTilde, float &nx, float &ny, float &lambda) {
+    float halfWidth = box->width * 0.5f;
+    float halfHeight = box->height * 0.5f;
+    float closestX = std::max(box->x - halfWidth, std::min(ball->x, box->x + halfWidth));
+    float closestY = std::max(box->y - halfHeight, std::min(ball->y, box->y + halfHeight));
+    float diffX = ball->x - closestX;
+    float diffY = ball->y - closestY;
+    float distance = std::hypot(diffX, diffY);
+
+    float c;
+    if (distance > 0.0f) {
+        if (distance >= ball->radius)
+            return false;
+        nx = diffX / distance;
+        ny = diffY / distance;
+        c = distance - ball->radius;
+    } else {
+        // The centre is inside the box: push out through the nearest face.
+        float left   = ball->x - (box->x - halfWidth);
+        float right  = (box->x + halfWidth) - ball->x;
+        float top    = ball->y - (box->y - halfHeight);
+        float bottom = (box->y + halfHeight) - ball->y;
+        float depth = left;
+        nx = -1.0f; ny = 0.0f;
+        if (right < depth)  { depth = right;  nx = 1.0f; ny = 0.0f; }
+        if (top < depth)    { depth = top;    nx = 0.0f; ny = -1.0f; }
+        if (bottom < depth) { depth = bottom; nx = 0.0f; ny = 1.0f; }
+        c = -(depth + ball->radius);
+    }
+
+    lambda = -c / (1.0f + alphaTilde);
+    ball->x += nx * lambda;
+    ball->y += ny * lambda;
+    return true;
+}
+
+// Move two touching balls apart. Returns false if they do not touch.
+// The normal points from a to b.
+static bool projectBallBall(Ball* a, Ball* b, float alphaTilde, float &nx, float &ny, float &lambda) {
+    float dx = b->x - a->x;
+    float dy = b->y - a->y;
+    float distance = std::hypot(dx, dy);
+    float c = distance - (a->radius + b->radius);
+    if (c >= 0.0f || distance == 0.0f)
+        return false;
+
+    nx = dx / distance;
+    ny = dy / distance;
+    // Both balls have unit mass, so the correction is shared equally.
+    lambda = -c / (2.0f + alphaTilde);
+    a->x -= nx * lambda;
+    a->y -= ny * lambda;
+    b->x += nx * lambda;
+    b->y += ny * lambda;
+    return true;
+}
+
+// Velocity change along a contact normal that replaces the separation velocity
+// introduced by the position projection with a restituted bounce.
+static float restitutionDelta(float vn, float vnBefore, float h, const WorldParams& params) {
+    // Slow contacts do not bounce; this keeps resting piles from jittering.
+    float restitution = std::fabs(vnBefore) <= 2.0f * std::fabs(params.gravity) * h ? 0.0f : params.bounceDamping;
+    return std::max(-restitution * vnBefore, 0.0f) - vn;
+}
+
+// Apply restitution against a wall. sign is +1 if the wall normal points along
+// the positive axis, -1 otherwise.
+static void bounceOffWall(float &v, float vBefore, float sign, float h, const WorldParams& params) {
+    float vn = sign * v;
+    v += sign * restitutionDelta(vn, sign * vBefore, h, params);
+}
+
+// Explicit Euler step of the balls in [begin, end). Terms the world does not
+// have are compiled out; friction is applied by the velocity pass.
+template <bool Gravity, bool Drag, bool Friction>
+struct IntegrateBalls {
+    static void run(std::vector<Object*>& objects, size_t begin, size_t end, float h, const WorldParams& params) {
+        for (size_t i = begin; i < end; ++i) {
+            Object* obj = objects[i];
+            if (obj->type != ObjectType::BALL)
+                continue;
+            if (Drag)
+                obj->vx += -params.airDrag * obj->vx * h;
+            if (Gravity && Drag)
+                obj->vy += (params.gravity - params.airDrag * obj->vy) * h;
+            else if (Gravity)
+                obj->vy += params.gravity * h;
+            else if (Drag)
+                obj->vy += -params.airDrag * obj->vy * h;
+            obj->x += obj->vx * h;
+            obj->y += obj->vy * h;
+        }
+    }
+};
+
+template <typename Fn>
+void XPBDSolver::forEachColour(ThreadPool& pool, Fn fn) {
+    for (size_t k = 0; k < contacts.batchCount(); ++k) {
+        size_t begin, end;
+        contacts.batch(k, begin, end);
+        if (contacts.isSerialBatch(k)) {
+            for (size_t i = begin; i < end; ++i)
+                fn(i);
+            continue;
+        }
+        pool.parallelFor(end - begin, CONTACT_GRAIN, [&](size_t first, size_t last) {
+            for (size_t i = begin + first; i < begin + last; ++i)
+                fn(i);
+        });
+    }
+}
+
+void XPBDSolver::step(std::vector<Object*>& objects, float dt, const WorldBounds& bounds, const WorldParams& params,
+                      ThreadPool& pool) {
+    const size_t n = objects.size();
+    const int substeps = std::max(1, settings.substeps);
+    const float h = dt / substeps;
+
+    times = StepTimes();
+    double start = phaseClock();
+
+    // Detect once per step; balls are widened by how far they can travel.
+    contacts.margin = DETECTION_SLACK + 0.5f * std::fabs(params.gravity) * dt * dt;
+    contacts.sweepTime = dt;
+    contacts.prepare(objects, pool);
+    double now = phaseClock();
+    times.detect = now - start;
+
+    states.resize(contacts.contacts().size());
+    prevX.resize(n);
+    prevY.resize(n);
+    prevVx.resize(n);
+    prevVy.resize(n);
+    wallHits.resize(n);
+
+    for (int s = 0; s < substeps; ++s) {
+        start = now;
+        integrate(objects, h, params, pool);
+        now = phaseClock();
+        times.integrate += now - start;
+        start = now;
+        projectContacts(objects, h, pool);
+        projectWalls(objects, bounds, pool);
+        updateVelocities(objects, h, pool);
+        solveVelocities(objects, h, params, pool);
+        now = phaseClock();
+        times.solve += now - start;
+    }
+}
+
+void XPBDSolver::integrate(std::vector<Object*>& objects, float h, const WorldParams& params, ThreadPool& pool) {
+    pool.parallelFor(objects.size(), BODY_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Object* obj = objects[i];
+            prevX[i] = obj->x;
+            prevY[i] = obj->y;
+            prevVx[i] = obj->vx;
+            prevVy[i] = obj->vy;
+        }
+        dispatchKernel<IntegrateBalls>(params, objects, begin, end, h, params);
+    });
+}
+
+void XPBDSolver::projectContacts(std::vector<Object*>& objects, float h, ThreadPool& pool) {
+    const std::vector<Contact>& list = contacts.contacts();
+    const float alphaTilde = settings.compliance / (h * h);
+
+    forEachColour(pool, [&](size_t k) {
+        const Contact& c = list[k];
+        Object* a = objects[c.a];
+        Object* b = objects[c.b];
+        ContactState& state = states[k];
+        state.lambda = 0.0f;
+
+        if (a->type == ObjectType::BALL && b->type == ObjectType::BALL) {
+            if (projectBallBall(static_cast<Ball*>(a), static_cast<Ball*>(b), alphaTilde,
+                                state.nx, state.ny, state.lambda))
+                state.vnBefore = (prevVx[c.b] - prevVx[c.a]) * state.nx + (prevVy[c.b] - prevVy[c.a]) * state.ny;
+        } else if (a->type == ObjectType::BALL && b->type == ObjectType::BOX) {
+            if (projectBallBox(static_cast<Ball*>(a), static_cast<Box*>(b), alphaTilde,
+                               state.nx, state.ny, state.lambda))
+                state.vnBefore = prevVx[c.a] * state.nx + prevVy[c.a] * state.ny;
+        } else if (a->type == ObjectType::BOX && b->type == ObjectType::BALL) {
+            if (projectBallBox(static_cast<Ball*>(b), static_cast<Box*>(a), alphaTilde,
+                               state.nx, state.ny, state.lambda))
+                state.vnBefore = prevVx[c.b] * state.nx + prevVy[c.b] * state.ny;
+        }
+    });
+}
+
+void XPBDSolver::projectWalls(std::vector<Object*>& objects, const WorldBounds& bounds, ThreadPool& pool) {
+    // Open walls sit at infinity; every wall is a compare and selects.
+    const WallLimits walls(bounds);
+    pool.parallelFor(objects.size(), BODY_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            wallHits[i] = 0;
+            if (objects[i]->type != ObjectType::BALL)
+                continue;
+            Ball* ball = static_cast<Ball*>(objects[i]);
+            const float r = ball->radius;
+            float x = ball->x, y = ball->y;
+            const bool floor = y + r > walls.bottom;
+            y = floor ? walls.bottom - r : y;
+            const bool ceiling = y - r < walls.top;
+            y = ceiling ? walls.top + r : y;
+            const bool left = x - r < walls.left;
+            x = left ? walls.left + r : x;
+            const bool right = x + r > walls.right;
+            x = right ? walls.right - r : x;
+            ball->x = x;
+            ball->y = y;
+            wallHits[i] = (floor ? WALL_FLOOR : 0) | (ceiling ? WALL_CEILING : 0) | (left ? WALL_LEFT : 0) |
+                          (right ? WALL_RIGHT : 0);
+        }
+    });
+}
+
+void XPBDSolver::updateVelocities(std::vector<Object*>& objects, float h, ThreadPool& pool) {
+    const float invH = 1.0f / h;
+    pool.parallelFor(objects.size(), BODY_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Object* obj = objects[i];
+            if (obj->type != ObjectType::BALL)
+                continue;
+            obj->vx = (obj->x - prevX[i]) * invH;
+            obj->vy = (obj->y - prevY[i]) * invH;
+        }
+    });
+}
+
+void XPBDSolver::solveVelocities(std::vector<Object*>& objects, float h, const WorldParams& params,
+                                 ThreadPool& pool) {
+    const std::vector<Contact>& list = contacts.contacts();
+    const float frictionCoefficient = params.frictionCoefficient;
+
+    forEachColour(pool, [&](size_t k) {
+        const ContactState& state = states[k];
+        if (state.lambda <= 0.0f)
+            return;
+        const Contact& c = list[k];
+        Object* a = objects[c.a];
+        Object* b = objects[c.b];
+        const float nx = state.nx, ny = state.ny;
+        // Normal force of the projection; bounds the friction we may apply.
+        const float normalForce = state.lambda / (h * h);
+
+        if (a->type == ObjectType::BALL && b->type == ObjectType::BALL) {
+            float rvx = b->vx - a->vx;
+            float rvy = b->vy - a->vy;
+            float vn = rvx * nx + rvy * ny;
+            float tx = rvx - vn * nx;
+            float ty = rvy - vn * ny;
+            float vt = std::hypot(tx, ty);
+            float dvx = 0.0f, dvy = 0.0f;
+            if (frictionCoefficient != 0.0f && vt > 1e-4f) {
+                float friction = std::min(h * frictionCoefficient * normalForce, vt);
+                dvx -= tx / vt * friction;
+                dvy -= ty / vt * friction;
+            }
+            float dvn = restitutionDelta(vn, state.vnBefore, h, params);
+            dvx += nx * dvn;
+            dvy += ny * dvn;
+            // Equal masses share the relative velocity change.
+            a->vx -= dvx * 0.5f;
+            a->vy -= dvy * 0.5f;
+            b->vx += dvx * 0.5f;
+            b->vy += dvy * 0.5f;
+        } else {
+            Object* ball = a->type == ObjectType::BALL ? a : b;
+            float vn = ball->vx * nx + ball->vy * ny;
+            float tx = ball->vx - vn * nx;
+            float ty = ball->vy - vn * ny;
+            float vt = std::hypot(tx, ty);
+            if (frictionCoefficient != 0.0f && vt > 1e-4f) {
+                float friction = std::min(h * frictionCoefficient * normalForce, vt);
+                ball->vx -= tx / vt * friction;
+                ball->vy -= ty / vt * friction;
+            }
+            float dvn = restitutionDelta(vn, state.vnBefore, h, params);
+            ball->vx += nx * dvn;
+            ball->vy += ny * dvn;
+        }
+    });
+
+    pool.parallelFor(objects.size(), BODY_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const uint8_t hits = wallHits[i];
+            if (hits == 0)
+                continue;
+            Object* obj = objects[i];
+            if (hits & WALL_FLOOR) {
+                bounceOffWall(obj->vy, prevVy[i], -1.0f, h, params);
+                float frictionDelta = params.groundFriction * h;
+                if (std::fabs(obj->vx) < frictionDelta)
+                    obj->vx = 0;
+                else
+                    obj->vx -= (obj->vx > 0 ? frictionDelta : -frictionDelta);
+            }
+            if (hits & WALL_CEILING)
+                bounceOffWall(obj->vy, prevVy[i], 1.0f, h, params);
+            if (hits & WALL_LEFT)
+                bounceOffWall(obj->vx, prevVx[i], 1.0f, h, params);
+            if (hits & WALL_RIGHT)
+                bounceOffWall(obj->vx, prevVx[i], -1.0f, h, params);
+        }
+    });
+}
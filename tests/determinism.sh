@@ -0,0 +1,37 @@
+#!/bin/sh
+# Run every generated scene with both solvers on 1, 2, 4 and 16 physics
+# threads and check that the final state hashes are identical.
+#
+# Usage: tests/determinism.sh [path/to/simulation]
+
+SIMULATION=${1:-build/simulation}
+BALLS=${BALLS:-2000}
+STEPS=${STEPS:-300}
+
+failed=0
+for solver in impulse xpbd; do
+    flags=""
+    [ "$solver" = xpbd ] && flags="--xpbd"
+    for kind in rain hex pyramids avalanche gas; do
+        expected=""
+        for threads in 1 2 4 16; do
+            output=$("$SIMULATION" --generate $kind --balls $BALLS --bench $STEPS --threads $threads $flags) || {
+                echo "FAIL $kind $solver: simulation exited with an error on $threads threads"
+                failed=1
+                continue
+            }
+            hash=$(echo "$output" | sed -n 's/.*hash \([0-9a-f]*\).*/\1/p')
+            if [ -z "$hash" ]; then
+                echo "FAIL $kind $solver: no hash in output on $threads threads: $output"
+                failed=1
+            elif [ -z "$expected" ]; then
+                expected=$hash
+            elif [ "$hash" != "$expected" ]; then
+                echo "FAIL $kind $solver: hash $hash on $threads threads, $expected on 1 thread"
+                failed=1
+            fi
+        done
+        [ -n "$expected" ] && echo "ok   $kind $solver $expected"
+    done
+done
+exit $failed
@@ -0,0 +1,135 @@
+// Build-time tool: rasterises the printable ASCII glyphs of a TTF font into a
+// BitmapFont and writes it as a C++ header that embeds the serialized blob.
+//
+// Usage: bake_font <font.ttf> <point size> <output.hpp>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include "bitmap_font.hpp"
+
+constexpr int ATLAS_WIDTH = 512;
+constexpr int GLYPH_PADDING = 1;
+
+static bool rasterise(TTF_Font* font, BitmapFont& out) {
+    struct Image {
+        std::vector<uint8_t> alpha;
+        int width, height;
+    };
+    std::vector<Image> images(BitmapFont::GLYPH_COUNT);
+    const SDL_Color white = {255, 255, 255, 255};
+    out.lineHeight = TTF_FontLineSkip(font);
+
+    // Render each glyph and crop it to the pixels it actually covers.
+    for (int i = 0; i < BitmapFont::GLYPH_COUNT; ++i) {
+        const Uint16 code = static_cast<Uint16>(BitmapFont::FIRST_CHAR + i);
+        Glyph& g = out.glyphs[i];
+        int minX, maxX, minY, maxY, advance;
+        if (TTF_GlyphMetrics(font, code, &minX, &maxX, &minY, &maxY, &advance) != 0)
+            advance = 0;
+        g = Glyph();
+        g.advance = static_cast<int16_t>(advance);
+        images[i].width = images[i].height = 0;
+
+        SDL_Surface* surface = TTF_RenderGlyph_Blended(font, code, white);
+        if (!surface)
+            continue;
+        // Blended glyphs are 32-bit ARGB; the alpha byte holds the coverage.
+        int left = surface->w, right = -1, top = surface->h, bottom = -1;
+        SDL_LockSurface(surface);
+        const uint8_t* rows = static_cast<const uint8_t*>(surface->pixels);
+        auto alphaAt = [&](int x, int y) {
+            return static_cast<uint8_t>(reinterpret_cast<const uint32_t*>(rows + y * surface->pitch)[x] >> 24);
+        };
+        for (int y = 0; y < surface->h; ++y) {
+            for (int x = 0; x < surface->w; ++x) {
+                if (alphaAt(x, y) == 0)
+                    continue;
+                left = std::min(left, x);
+                right = std::max(right, x);
+                top = std::min(top, y);
+                bottom = std::max(bottom, y);
+            }
+        }
+        if (right >= left) {
+            Image& image = images[i];
+            image.width = right - left + 1;
+            image.height = bottom - top + 1;
+            image.alpha.resize(static_cast<size_t>(image.width) * image.height);
+            for (int y = 0; y < image.height; ++y)
+                for (int x = 0; x < image.width; ++x)
+                    image.alpha[static_cast<size_t>(y) * image.width + x] = alphaAt(left + x, top + y);
+            g.width = static_cast<uint16_t>(image.width);
+            g.height = static_cast<uint16_t>(image.height);
+            g.offsetX = static_cast<int16_t>(left);
+            g.offsetY = static_cast<int16_t>(top);
+        }
+        SDL_UnlockSurface(surface);
+        SDL_FreeSurface(surface);
+    }
+
+    // Shelf-pack the cropped images.
+    int penX = 0, penY = 0, shelfHeight = 0;
+    for (int i = 0; i < BitmapFont::GLYPH_COUNT; ++i) {
+        const int w = images[i].width + GLYPH_PADDING, h = images[i].height + GLYPH_PADDING;
+        if (penX + w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += shelfHeight;
+            shelfHeight = 0;
+        }
+        out.glyphs[i].x = static_cast<uint16_t>(penX);
+        out.glyphs[i].y = static_cast<uint16_t>(penY);
+        penX += w;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+    out.width = ATLAS_WIDTH;
+    out.height = std::max(1, penY + shelfHeight);
+
+    out.coverage.assign(static_cast<size_t>(out.width) * out.height, 0);
+    for (int i = 0; i < BitmapFont::GLYPH_COUNT; ++i) {
+        const Image& image = images[i];
+        for (int y = 0; y < image.height; ++y)
+            std::copy(image.alpha.begin() + static_cast<size_t>(y) * image.width,
+                      image.alpha.begin() + static_cast<size_t>(y + 1) * image.width,
+                      out.coverage.begin() + static_cast<size_t>(out.glyphs[i].y + y) * out.width + out.glyphs[i].x);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <font.ttf> <point size> <output.hpp>\n";
+        return 1;
+    }
+    if (TTF_Init() != 0) {
+        std::cerr << "TTF_Init Error: " << TTF_GetError() << "\n";
+        return 1;
+    }
+    TTF_Font* font = TTF_OpenFont(argv[1], std::atoi(argv[2]));
+    if (!font) {
+        std::cerr << "TTF_OpenFont Error: " << TTF_GetError() << "\n";
+        TTF_Quit();
+        return 1;
+    }
+    BitmapFont bitmapFont;
+    rasterise(font, bitmapFont);
+    TTF_CloseFont(font);
+    TTF_Quit();
+
+    const std::vector<uint8_t> blob = bitmapFont.serialize();
+    FILE* file = std::fopen(argv[3], "w");
+    if (!file) {
+        std::cerr << "Cannot write " << argv[3] << "\n";
+        return 1;
+    }
+    std::fprintf(file, "// Generated by tools/bake_font.cpp from %s at %s pt. Do not edit.\n", argv[1], argv[2]);
+    std::fprintf(file, "#ifndef FONT_BITMAP_HPP\n#define FONT_BITMAP_HPP\n\n");
+    std::fprintf(file, "static const unsigned char font_bitmap[] = {");
+    for (size_t i = 0; i < blob.size(); ++i)
+        std::fprintf(file, "%s0x%02x,", i % 16 == 0 ? "\n  " : " ", blob[i]);
+    std::fprintf(file, "\n};\nstatic const unsigned int font_bitmap_len = %u;\n\n", static_cast<unsigned>(blob.size()));
+    std::fprintf(file, "#endif // FONT_BITMAP_HPP\n");
+    return std::fclose(file) == 0 ? 0 : 1;
+}